@@ -0,0 +1,116 @@
+#pragma once
+
+#include "certificate.h"
+#include "deterministic.h"
+#include "hypergraph.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+struct ApproxOptions {
+    // Target relative error of the sampled cut values.
+    double epsilon = 0.1;
+    // Constant c in the sampling rate p = c ln n / (epsilon^2 lambda).
+    double oversampling = 3.0;
+    // 0 draws the seed from std::random_device.
+    uint64_t seed = 0;
+    // Re-estimates of lambda before the last sample is accepted.
+    uint32_t maxRounds = 8;
+};
+
+struct ApproxCutResult {
+    // Weight in H of `side`, so an upper bound on the min cut that always holds.
+    uint64_t cutWeight;
+    // Min cut of the last sample divided by p (1 + epsilon), capped at cutWeight.
+    // Not a guaranteed bound: the rate below ignores edge rank and starts from an
+    // estimate at or above lambda. Equals cutWeight when the sample was exact.
+    uint64_t sampleEstimate;
+    double samplingRate;
+    uint32_t rounds;
+    std::vector<bool> side;
+};
+
+inline uint64_t cutWeightOf(const Hypergraph &H, const std::vector<bool> &side) {
+    uint64_t total = 0;
+    for (size_t e = 0; e < H.numEdges(); ++e) {
+        auto pins = H.edgePins(e);
+        if (pins.empty())
+            continue;
+        const bool first = side[pins[0]];
+        if (std::any_of(pins.begin() + 1, pins.end(), [&](uint32_t v) { return side[v] != first; }))
+            total += H.weight(e);
+    }
+    return total;
+}
+
+// Every unit of edge weight survives independently with probability p, so an edge
+// keeps Binomial(w, p) units and every cut of the sample is p times its value in H
+// in expectation. For graphs, p = c ln n / (epsilon^2 lambda) keeps all cuts within
+// 1 +- epsilon (Karger); hypergraphs of rank r need about r times that, so here the
+// rate is a heuristic and only cutWeight is trusted. lambda is not known up front:
+// it starts at the minimum weighted degree and is replaced by the weight in H of
+// each sampled min cut, until that estimate stops falling by more than a factor 1 + epsilon.
+//
+// Thinning alone rarely drops edges when weights are large, so each sample is
+// solved on k-trimmed certificates with k doubling from half its expected min cut
+// p lambda. That value is O(log n / epsilon^2), so the solver sees O(n log n / epsilon^2) pins.
+inline ApproxCutResult approximateMinCut(const Hypergraph &H, const ApproxOptions &options = {}) {
+    ApproxCutResult result{0, 0, 1.0, 0, std::vector<bool>(H.n, false)};
+    if (H.n <= 1)
+        return result;
+
+    std::vector<uint64_t> degree(H.n, 0);
+    for (size_t e = 0; e < H.numEdges(); ++e)
+        for (uint32_t v : H.edgePins(e))
+            degree[v] += H.weight(e);
+    uint64_t estimate = *std::min_element(degree.begin(), degree.end());
+
+    std::mt19937_64 rng(options.seed ? options.seed : std::random_device{}());
+    const double eps = options.epsilon;
+    const double rateNumerator = options.oversampling * std::log(static_cast<double>(H.n)) / (eps * eps);
+
+    result.cutWeight = std::numeric_limits<uint64_t>::max();
+    std::vector<bool> side;
+    while (result.rounds < std::max(1u, options.maxRounds)) {
+        ++result.rounds;
+        const double p = estimate == 0 ? 1.0 : std::min(1.0, rateNumerator / static_cast<double>(estimate));
+
+        Hypergraph sample;
+        if (p < 1.0) {
+            sample.n = H.n;
+            sample.reserve(H.numEdges(), H.numPins());
+            for (size_t e = 0; e < H.numEdges(); ++e) {
+                const uint32_t w = std::binomial_distribution<uint32_t>(H.weight(e), p)(rng);
+                if (w > 0)
+                    sample.addEdge(H.edgePins(e), w);
+            }
+        }
+        const Hypergraph &G = p < 1.0 ? sample : H;
+        uint64_t sampleCut;
+        for (uint64_t k = std::max<uint64_t>(1, static_cast<uint64_t>(p * estimate / 2));; k *= 2) {
+            const Hypergraph C = sparseCertificate(G, k);
+            sampleCut = deterministicMinCut(C, &side);
+            if (sampleCut < k || C.numPins() == G.numPins())
+                break;
+        }
+
+        const uint64_t weight = cutWeightOf(H, side);
+        if (weight < result.cutWeight) {
+            result.cutWeight = weight;
+            result.side = side;
+        }
+        result.samplingRate = p;
+        if (p >= 1.0) {
+            result.sampleEstimate = result.cutWeight;
+            break;
+        }
+        result.sampleEstimate = std::min(result.cutWeight, static_cast<uint64_t>(sampleCut / (p * (1.0 + eps))));
+        if (static_cast<double>(weight) * (1.0 + eps) >= static_cast<double>(estimate))
+            break;
+        estimate = weight;
+    }
+    return result;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// Monotonic bump allocator whose memory survives reset(). deallocate() is a no-op;
+// reset() rewinds to the start, and if the last cycle spilled into extra chunks
+// they are replaced by one chunk large enough for the whole cycle, so a steady
+// workload resets in O(1) and stops calling malloc altogether.
+//
+// Not thread-safe: one arena belongs to one worker slot or task at a time.
+class Arena : public std::pmr::memory_resource {
+    // Chunks start on a cache line, so requests up to this alignment need no padding there.
+    static constexpr size_t CHUNK_ALIGNMENT = 64;
+
+    struct ChunkDelete {
+        void operator()(std::byte *p) const noexcept { ::operator delete(p, std::align_val_t{CHUNK_ALIGNMENT}); }
+    };
+    struct Chunk {
+        std::unique_ptr<std::byte[], ChunkDelete> data;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;
+    size_t current = 0;
+    size_t used = 0;
+    size_t allocated = 0;
+
+    void addChunk(size_t size) {
+        auto *data = static_cast<std::byte *>(::operator new(size, std::align_val_t{CHUNK_ALIGNMENT}));
+        chunks.push_back({std::unique_ptr<std::byte[], ChunkDelete>(data), size});
+    }
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        while (true) {
+            Chunk &chunk = chunks[current];
+            // Aligns the address rather than the offset, which matters above CHUNK_ALIGNMENT.
+            const auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+            const size_t start = ((base + used + alignment - 1) & ~(alignment - 1)) - base;
+            if (start + bytes <= chunk.size) {
+                used = start + bytes;
+                allocated += bytes;
+                return chunk.data.get() + start;
+            }
+            if (++current == chunks.size())
+                addChunk(std::max(chunks.back().size * 2, bytes + alignment));
+            used = 0;
+        }
+    }
+
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+  public:
+    explicit Arena(size_t initialBytes = 64 << 10) { addChunk(initialBytes); }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void reset() {
+        if (chunks.size() > 1) {
+            size_t total = 0;
+            for (const auto &chunk : chunks)
+                total += chunk.size;
+            chunks.clear();
+            addChunk(total);
+        }
+        current = 0;
+        used = 0;
+    }
+
+    // Bytes handed out since construction; never decreases.
+    size_t bytesAllocated() const noexcept { return allocated; }
+};
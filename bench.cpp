@@ -0,0 +1,568 @@
+#include "approx.h"
+#include "certificate.h"
+#include "deterministic.h"
+#include "generators.h"
+#include "hypergraph_cache.h"
+#include "instrument.h"
+#include "randomized.h"
+#include "reduction.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Benchmark driver. Instances are generated or loaded before any timing starts,
+// every (instance, solver) pair gets untimed warmup runs, and the timed runs are
+// summarized into one row of a fixed JSON or CSV schema. A CSV written by an
+// earlier run can be passed as --baseline to flag median time regressions.
+
+static const char *USAGE = R"(usage: hypergraph_min_cut_bench [options]
+  --solver LIST          comma-separated: deterministic, deterministic-bucket,
+                         certified, randomized, karger-stein, approx (default deterministic)
+  --generator NAME       uniform (default), power-law, netlist, or planted-uniform,
+                         planted-power-law, planted-netlist: two halves of n/2 vertices
+                         and m/2 edges joined by a cut of known weight; ignored with --files
+  --files PATH           hMETIS file or directory of them; repeatable
+  --synthetic-weights    replace file edge weights with uniform [1, 100] draws
+  --n N --m M --rank R   generator size and edge size (default 500 1000 10)
+  --max-weight W         generator edge weights are uniform in [1, W] (default 100)
+  --crossing-edges C     edges across the planted cut (default 16)
+  --k K                  number of parts (default 2)
+  --seeds LIST           generator seeds, one instance each (default 1)
+  --repetitions N        timed runs per instance and solver (default 5)
+  --warmup N             untimed runs before them (default 1)
+  --threads N            worker threads for the randomized and deterministic solvers
+                         and the generators; 0 = all (default 1)
+  --format json|csv      output format (default json)
+  --output PATH          write results here instead of stdout
+  --baseline PATH        CSV from an earlier run to compare against
+  --tolerance X          relative median slowdown that counts as a regression (default 0.05)
+  --profile              add per-phase timers, allocations, recursion depths and
+                         hardware counters to the JSON rows (needs -DHMC_INSTRUMENT=ON)
+  --bounds               seed the deterministic and randomized solvers with cutBounds()
+                         (k = 2 only)
+  --kernelize            solve the kernelize() kernel of each instance instead of the
+                         instance itself; the reduction is timed (k = 2 only)
+  --quiet                no progress on stderr
+)";
+
+struct BenchConfig {
+    std::vector<std::string> solvers{"deterministic"};
+    std::string generator = "uniform";
+    std::vector<std::string> files;
+    bool syntheticWeights = false;
+    uint32_t n = 500;
+    uint32_t m = 1000;
+    uint32_t rank = 10;
+    uint32_t maxWeight = 100;
+    uint32_t crossingEdges = 16;
+    uint32_t k = 2;
+    std::vector<uint64_t> seeds{1};
+    uint32_t repetitions = 5;
+    uint32_t warmup = 1;
+    unsigned threads = 1;
+    std::string format = "json";
+    std::string output;
+    std::string baseline;
+    double tolerance = 0.05;
+    bool profile = false;
+    bool quiet = false;
+    bool bounds = false;
+    bool kernelize = false;
+};
+
+struct Instance {
+    std::string name;
+    Hypergraph H;
+    // Minimum 2-cut weight, known for planted instances.
+    std::optional<uint64_t> expectedCut;
+};
+
+// Returns the cut weight; seed varies per run so randomized solvers do not repeat themselves.
+using SolverFn = std::function<uint64_t(const Hypergraph &, const BenchConfig &, uint64_t seed)>;
+using GeneratorFn = std::function<Instance(const BenchConfig &, uint64_t seed)>;
+
+struct SolverInfo {
+    SolverFn run;
+    bool onlyTwoWay;
+};
+
+// Computed inside the timed run, so its cost counts against the solver.
+static std::optional<CutBounds> solverBounds(const Hypergraph &H, const BenchConfig &config) {
+    if (!config.bounds || config.k != 2)
+        return std::nullopt;
+    return cutBounds(H);
+}
+
+static const std::map<std::string, SolverInfo> &solvers() {
+    static const std::map<std::string, SolverInfo> table{
+        {"deterministic",
+         {[](const Hypergraph &H, const BenchConfig &config, uint64_t) {
+              const auto bounds = solverBounds(H, config);
+              return deterministicMinCut<AddressableMaxHeap>(H, nullptr, nullptr, config.threads, bounds ? &*bounds : nullptr);
+          },
+          true}},
+        {"deterministic-bucket",
+         {[](const Hypergraph &H, const BenchConfig &config, uint64_t) {
+              const auto bounds = solverBounds(H, config);
+              return deterministicMinCut<BucketQueue>(H, nullptr, nullptr, config.threads, bounds ? &*bounds : nullptr);
+          },
+          true}},
+        {"certified",
+         {[](const Hypergraph &H, const BenchConfig &, uint64_t) { return certifiedMinCut(H, [](const Hypergraph &G) { return deterministicMinCut(G); }); },
+          true}},
+        {"randomized",
+         {[](const Hypergraph &H, const BenchConfig &config, uint64_t seed) {
+              const auto bounds = solverBounds(H, config);
+              return randomizedMinKCut(H, config.k, RandomizedOptions{.baseSeed = seed, .threads = config.threads, .bounds = bounds ? &*bounds : nullptr})
+                  .cutWeight;
+          },
+          false}},
+        {"karger-stein",
+         {[](const Hypergraph &H, const BenchConfig &config, uint64_t seed) {
+              const auto bounds = solverBounds(H, config);
+              return randomizedMinKCut(H, config.k,
+                                       RandomizedOptions{.baseSeed = seed, .threads = config.threads, .mode = RandomizedMode::KargerStein,
+                                                         .bounds = bounds ? &*bounds : nullptr})
+                  .cutWeight;
+          },
+          true}},
+        {"approx", {[](const Hypergraph &H, const BenchConfig &, uint64_t seed) { return approximateMinCut(H, ApproxOptions{.seed = seed}).cutWeight; }, true}},
+    };
+    return table;
+}
+
+// The base families, with the vertex and edge counts passed in so the planted
+// variants can build each half with the same generator.
+using FamilyFn = std::function<Hypergraph(const BenchConfig &, uint32_t n, uint64_t m, uint64_t seed)>;
+
+static const std::map<std::string, FamilyFn> &families() {
+    static const std::map<std::string, FamilyFn> table{
+        {"uniform",
+         [](const BenchConfig &config, uint32_t n, uint64_t m, uint64_t seed) {
+             return uniformHypergraph(UniformOptions{.n = n, .m = m, .rank = std::min(config.rank, n), .maxWeight = config.maxWeight, .seed = seed,
+                                                     .threads = config.threads});
+         }},
+        {"power-law",
+         [](const BenchConfig &config, uint32_t n, uint64_t m, uint64_t seed) {
+             return powerLawHypergraph(PowerLawOptions{.n = n, .m = m, .maxRank = config.rank, .maxWeight = config.maxWeight, .seed = seed,
+                                                       .threads = config.threads});
+         }},
+        {"netlist",
+         [](const BenchConfig &config, uint32_t n, uint64_t m, uint64_t seed) {
+             return netlistHypergraph(NetlistOptions{.n = n, .m = m, .maxRank = config.rank, .maxWeight = config.maxWeight, .seed = seed,
+                                                     .threads = config.threads});
+         }},
+    };
+    return table;
+}
+
+static const std::map<std::string, GeneratorFn> &generators() {
+    static const std::map<std::string, GeneratorFn> table = [] {
+        std::map<std::string, GeneratorFn> table;
+        for (const auto &[name, family] : families()) {
+            table[name] = [family](const BenchConfig &config, uint64_t seed) { return Instance{{}, family(config, config.n, config.m, seed), {}}; };
+            table["planted-" + name] = [family](const BenchConfig &config, uint64_t seed) {
+                const uint32_t left = config.n / 2;
+                Hypergraph L = family(config, left, config.m / 2, splitmix64(seed));
+                Hypergraph R = family(config, config.n - left, config.m - config.m / 2, splitmix64(seed + 1));
+                PlantedHypergraph planted =
+                    plantCut(L, R, PlantOptions{.crossingEdges = config.crossingEdges, .maxWeight = config.maxWeight, .seed = seed});
+                return Instance{{}, std::move(planted.H), planted.minCut};
+            };
+        }
+        return table;
+    }();
+    return table;
+}
+
+static std::vector<std::string> splitList(const std::string &list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    for (std::string item; std::getline(stream, item, ',');)
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+static uint64_t parseUnsigned(const std::string &flag, const std::string &value) {
+    size_t used = 0;
+    uint64_t parsed = 0;
+    try {
+        parsed = std::stoull(value, &used);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size())
+        throw std::runtime_error(flag + " expects a non-negative integer, got '" + value + "'");
+    return parsed;
+}
+
+static BenchConfig parseArgs(int argc, char *argv[]) {
+    BenchConfig config;
+    auto value = [&](int &i) -> std::string {
+        if (i + 1 >= argc)
+            throw std::runtime_error(std::string(argv[i]) + " expects a value");
+        return argv[++i];
+    };
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "--solver")
+            config.solvers = splitList(value(i));
+        else if (flag == "--generator")
+            config.generator = value(i);
+        else if (flag == "--files")
+            config.files.push_back(value(i));
+        else if (flag == "--synthetic-weights")
+            config.syntheticWeights = true;
+        else if (flag == "--n")
+            config.n = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--m")
+            config.m = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--rank")
+            config.rank = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--max-weight")
+            config.maxWeight = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--crossing-edges")
+            config.crossingEdges = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--k")
+            config.k = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--seeds") {
+            config.seeds.clear();
+            for (const auto &seed : splitList(value(i)))
+                config.seeds.push_back(parseUnsigned(flag, seed));
+        } else if (flag == "--repetitions")
+            config.repetitions = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--warmup")
+            config.warmup = static_cast<uint32_t>(parseUnsigned(flag, value(i)));
+        else if (flag == "--threads")
+            config.threads = static_cast<unsigned>(parseUnsigned(flag, value(i)));
+        else if (flag == "--format")
+            config.format = value(i);
+        else if (flag == "--output")
+            config.output = value(i);
+        else if (flag == "--baseline")
+            config.baseline = value(i);
+        else if (flag == "--tolerance")
+            config.tolerance = std::stod(value(i));
+        else if (flag == "--profile")
+            config.profile = true;
+        else if (flag == "--bounds")
+            config.bounds = true;
+        else if (flag == "--kernelize")
+            config.kernelize = true;
+        else if (flag == "--quiet")
+            config.quiet = true;
+        else
+            throw std::runtime_error("unknown option " + flag);
+    }
+
+    if (config.solvers.empty() || config.repetitions == 0 || config.seeds.empty())
+        throw std::runtime_error("need at least one solver, seed and repetition");
+    if (config.format != "json" && config.format != "csv")
+        throw std::runtime_error("--format must be json or csv");
+    if (config.k < 2)
+        throw std::runtime_error("--k must be at least 2");
+    for (const auto &name : config.solvers) {
+        auto it = solvers().find(name);
+        if (it == solvers().end())
+            throw std::runtime_error("unknown solver " + name);
+        if (it->second.onlyTwoWay && config.k != 2)
+            throw std::runtime_error("solver " + name + " only supports k = 2");
+    }
+    if (config.files.empty()) {
+        if (!generators().contains(config.generator))
+            throw std::runtime_error("unknown generator " + config.generator);
+        if (config.rank > config.n || config.rank == 0 || config.maxWeight == 0)
+            throw std::runtime_error("generator needs 1 <= rank <= n and max weight >= 1");
+        if (config.generator.starts_with("planted-") && config.n < 2)
+            throw std::runtime_error("planted generators need n >= 2");
+    }
+    return config;
+}
+
+static std::vector<Instance> buildInstances(const BenchConfig &config) {
+    std::vector<Instance> instances;
+    auto load = [&](const std::filesystem::path &path) {
+        instances.push_back({path.filename().string(), loadHypergraph(path.string(), HgrOptions{.syntheticWeights = config.syntheticWeights})});
+    };
+    for (const auto &file : config.files) {
+        if (!std::filesystem::is_directory(file)) {
+            load(file);
+            continue;
+        }
+        std::vector<std::filesystem::path> paths;
+        for (const auto &entry : std::filesystem::directory_iterator(file))
+            if (entry.is_regular_file() && entry.path().extension() != ".hgrb")
+                paths.push_back(entry.path());
+        std::sort(paths.begin(), paths.end());
+        for (const auto &path : paths)
+            load(path);
+    }
+    if (config.files.empty()) {
+        const auto &generate = generators().at(config.generator);
+        for (uint64_t seed : config.seeds) {
+            std::ostringstream name;
+            name << config.generator << "-n" << config.n << "-m" << config.m << "-r" << config.rank << "-w" << config.maxWeight;
+            if (config.generator.starts_with("planted-"))
+                name << "-c" << config.crossingEdges;
+            name << "-s" << seed;
+            Instance instance = generate(config, seed);
+            instance.name = name.str();
+            instances.push_back(std::move(instance));
+        }
+    }
+    return instances;
+}
+
+struct Summary {
+    double mean = 0, variance = 0, stddev = 0, min = 0, p05 = 0, median = 0, p95 = 0, max = 0;
+};
+
+// Percentiles interpolate linearly between order statistics; variance is the sample variance.
+static Summary summarize(std::vector<double> samples) {
+    Summary s;
+    std::sort(samples.begin(), samples.end());
+    const size_t count = samples.size();
+    auto percentile = [&](double q) {
+        const double rank = q * static_cast<double>(count - 1);
+        const size_t lo = static_cast<size_t>(rank);
+        const size_t hi = std::min(lo + 1, count - 1);
+        return samples[lo] + (rank - static_cast<double>(lo)) * (samples[hi] - samples[lo]);
+    };
+    for (double x : samples)
+        s.mean += x;
+    s.mean /= static_cast<double>(count);
+    for (double x : samples)
+        s.variance += (x - s.mean) * (x - s.mean);
+    s.variance = count > 1 ? s.variance / static_cast<double>(count - 1) : 0.0;
+    s.stddev = std::sqrt(s.variance);
+    s.min = samples.front();
+    s.max = samples.back();
+    s.p05 = percentile(0.05);
+    s.median = percentile(0.5);
+    s.p95 = percentile(0.95);
+    return s;
+}
+
+struct BenchRow {
+    std::string instance;
+    uint32_t n;
+    size_t m;
+    size_t pins;
+    std::string solver;
+    uint32_t k;
+    unsigned threads;
+    uint32_t repetitions;
+    uint64_t cutMin;
+    uint64_t cutMax;
+    // Only for planted instances and k = 2.
+    std::optional<uint64_t> expectedCut;
+    Summary timeMs;
+    // Summed over the timed runs when --profile is given.
+    std::optional<Profile> profile;
+};
+
+// One run of solve, on the kernel of H when --kernelize is given.
+static uint64_t runSolver(const SolverFn &solve, const Hypergraph &H, const BenchConfig &config, uint64_t seed) {
+    if (!config.kernelize || config.k != 2)
+        return solve(H, config, seed);
+    return reducedMinCut(H, [&](const Hypergraph &G) { return solve(G, config, seed); });
+}
+
+static BenchRow runBenchmark(const Instance &instance, const std::string &solverName, const BenchConfig &config) {
+    const SolverFn &solve = solvers().at(solverName).run;
+    uint64_t seed = 1;
+    for (uint32_t i = 0; i < config.warmup; ++i)
+        runSolver(solve, instance.H, config, seed++);
+
+    BenchRow row{instance.name, instance.H.n, instance.H.numEdges(), instance.H.numPins(), solverName, config.k, config.threads, config.repetitions,
+                 std::numeric_limits<uint64_t>::max(), 0, config.k == 2 ? instance.expectedCut : std::nullopt, {}};
+    std::vector<double> times;
+    times.reserve(config.repetitions);
+    if (config.profile)
+        row.profile.emplace();
+    for (uint32_t i = 0; i < config.repetitions; ++i) {
+        std::optional<ProfileSession> session;
+        if (config.profile)
+            session.emplace(true);
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t cut = runSolver(solve, instance.H, config, seed++);
+        const auto end = std::chrono::steady_clock::now();
+        if (session)
+            row.profile->merge(session->stop());
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        row.cutMin = std::min(row.cutMin, cut);
+        row.cutMax = std::max(row.cutMax, cut);
+    }
+    row.timeMs = summarize(std::move(times));
+    return row;
+}
+
+static const char *CSV_HEADER = "instance,n,m,pins,solver,k,threads,repetitions,cut_min,cut_max,"
+                                "mean_ms,variance_ms2,stddev_ms,min_ms,p05_ms,median_ms,p95_ms,max_ms";
+
+static void writeCsv(std::ostream &out, const std::vector<BenchRow> &rows) {
+    out << CSV_HEADER << "\n" << std::setprecision(6) << std::fixed;
+    for (const auto &r : rows) {
+        const Summary &t = r.timeMs;
+        out << r.instance << "," << r.n << "," << r.m << "," << r.pins << "," << r.solver << "," << r.k << "," << r.threads << "," << r.repetitions
+            << "," << r.cutMin << "," << r.cutMax << "," << t.mean << "," << t.variance << "," << t.stddev << "," << t.min << "," << t.p05 << ","
+            << t.median << "," << t.p95 << "," << t.max << "\n";
+    }
+}
+
+static std::string jsonString(const std::string &s) {
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static void writeJson(std::ostream &out, const std::vector<BenchRow> &rows, const BenchConfig &config) {
+    out << std::setprecision(6) << std::fixed;
+    out << "{\n  \"schema\": \"hypergraph-min-cut-bench/1\",\n";
+    out << "  \"config\": {\"warmup\": " << config.warmup << ", \"repetitions\": " << config.repetitions << ", \"threads\": " << config.threads
+        << ", \"k\": " << config.k << "},\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const BenchRow &r = rows[i];
+        const Summary &t = r.timeMs;
+        out << (i ? ",\n" : "\n") << "    {\"instance\": " << jsonString(r.instance) << ", \"n\": " << r.n << ", \"m\": " << r.m << ", \"pins\": " << r.pins
+            << ", \"solver\": " << jsonString(r.solver) << ", \"k\": " << r.k << ", \"threads\": " << r.threads << ", \"repetitions\": " << r.repetitions
+            << ", \"cut_min\": " << r.cutMin << ", \"cut_max\": " << r.cutMax;
+        if (r.expectedCut)
+            out << ", \"expected_cut\": " << *r.expectedCut;
+        out << ", \"time_ms\": {\"mean\": " << t.mean << ", \"variance\": " << t.variance
+            << ", \"stddev\": " << t.stddev << ", \"min\": " << t.min << ", \"p05\": " << t.p05 << ", \"median\": " << t.median << ", \"p95\": " << t.p95
+            << ", \"max\": " << t.max << "}";
+        if (r.profile) {
+            out << ", \"profile\": ";
+            r.profile->writeJson(out);
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+struct BaselineEntry {
+    uint64_t cutMin;
+    double medianMs;
+};
+
+static std::string baselineKey(const std::string &instance, const std::string &solver, uint32_t k, unsigned threads) {
+    return instance + "," + solver + "," + std::to_string(k) + "," + std::to_string(threads);
+}
+
+static std::map<std::string, BaselineEntry> readBaseline(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("cannot open baseline " + path);
+    std::string line;
+    if (!std::getline(in, line) || line != CSV_HEADER)
+        throw std::runtime_error("baseline " + path + " is not a CSV written by this benchmark");
+    std::map<std::string, BaselineEntry> entries;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        for (std::string field; std::getline(stream, field, ',');)
+            fields.push_back(field);
+        if (fields.size() != 18)
+            continue;
+        entries[baselineKey(fields[0], fields[4], std::stoul(fields[5]), std::stoul(fields[6]))] = {std::stoull(fields[8]), std::stod(fields[15])};
+    }
+    return entries;
+}
+
+// Prints one line per row with a baseline entry; returns the number of regressions.
+static size_t compareBaseline(const std::vector<BenchRow> &rows, const std::map<std::string, BaselineEntry> &baseline, double tolerance) {
+    size_t regressions = 0;
+    for (const auto &r : rows) {
+        auto it = baseline.find(baselineKey(r.instance, r.solver, r.k, r.threads));
+        if (it == baseline.end())
+            continue;
+        const double ratio = r.timeMs.median / std::max(it->second.medianMs, 1e-9);
+        const bool slower = ratio > 1.0 + tolerance;
+        const bool cutChanged = r.cutMin != it->second.cutMin;
+        regressions += slower || cutChanged;
+        std::cerr << (slower || cutChanged ? "REGRESSION " : "ok         ") << r.instance << " " << r.solver << ": median " << r.timeMs.median << " ms vs "
+                  << it->second.medianMs << " ms (x" << ratio << ")";
+        if (cutChanged)
+            std::cerr << ", cut " << r.cutMin << " vs " << it->second.cutMin;
+        std::cerr << "\n";
+    }
+    return regressions;
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig config;
+    try {
+        config = parseArgs(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n" << USAGE;
+        return 2;
+    }
+    if (config.profile && !ProfileSession().stop().enabled)
+        std::cerr << "built without HMC_INSTRUMENT: profiles will be empty\n";
+
+    // The solvers and generators log to std::cout; keep it clean for the results.
+    std::streambuf *stdoutBuffer = std::cout.rdbuf(nullptr);
+    std::ofstream file;
+    if (!config.output.empty()) {
+        file.open(config.output);
+        if (!file) {
+            std::cerr << "cannot open " << config.output << "\n";
+            return 2;
+        }
+    }
+    std::ostream out(config.output.empty() ? stdoutBuffer : file.rdbuf());
+
+    try {
+        std::map<std::string, BaselineEntry> baseline;
+        if (!config.baseline.empty())
+            baseline = readBaseline(config.baseline);
+
+        const std::vector<Instance> instances = buildInstances(config);
+        std::vector<BenchRow> rows;
+        for (const auto &instance : instances) {
+            for (const auto &solver : config.solvers) {
+                rows.push_back(runBenchmark(instance, solver, config));
+                if (!config.quiet)
+                    std::cerr << instance.name << " " << solver << ": cut " << rows.back().cutMin << ", median " << rows.back().timeMs.median << " ms\n";
+                const BenchRow &row = rows.back();
+                if (row.expectedCut && (row.cutMin != *row.expectedCut || row.cutMax != *row.expectedCut))
+                    std::cerr << "MISMATCH " << instance.name << " " << solver << ": cuts " << row.cutMin << ".." << row.cutMax << ", planted "
+                              << *row.expectedCut << "\n";
+            }
+        }
+
+        if (config.format == "csv")
+            writeCsv(out, rows);
+        else
+            writeJson(out, rows, config);
+        out.flush();
+        std::cout.rdbuf(stdoutBuffer);
+        if (!config.baseline.empty() && compareBaseline(rows, baseline, config.tolerance) > 0)
+            return 1;
+    } catch (const std::exception &e) {
+        std::cout.rdbuf(stdoutBuffer);
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "max_queue.h"
+#include "parallel.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Bounds on the minimum 2-cut, known before a solve. Both solvers accept them:
+// the upper bound seeds their best cut, so they can contract heavier edges and
+// prune from the start, and they stop as soon as a cut reaches the lower bound.
+struct CutBounds {
+    // Weight of the cut given by side, or UINT64_MAX with an empty side if none is known.
+    uint64_t upper = std::numeric_limits<uint64_t>::max();
+    std::vector<bool> side;
+    // No cut is lighter than this.
+    uint64_t lower = 0;
+
+    bool exact() const noexcept { return lower >= upper; }
+
+    void offer(uint64_t weight, std::vector<bool> cutSide) {
+        if (weight < upper) {
+            upper = weight;
+            side = std::move(cutSide);
+        }
+    }
+};
+
+struct BoundOptions {
+    // Greedy growths: maximum adjacency orderings from different start vertices,
+    // each contributing its lightest prefix. The first starts at vertex 0.
+    uint32_t greedyRuns = 3;
+    // Label propagation sweeps over the best cut found so far.
+    uint32_t refineRounds = 4;
+    uint64_t seed = 0;
+    // A lower bound the caller already knows, e.g. from an earlier solve.
+    uint64_t lower = 0;
+};
+
+// Lightest of the minimum weighted degree cut, the greedy growths and their
+// refinement by label propagation. O((greedyRuns log n + refineRounds) p).
+inline CutBounds cutBounds(const Hypergraph &H, const BoundOptions &options = {}) {
+    CutBounds bounds;
+    bounds.lower = options.lower;
+    if (H.n <= 1) {
+        bounds.offer(0, std::vector<bool>(H.n, false));
+        return bounds;
+    }
+
+    // Distinct pins of every edge spanning two or more vertices, and their incidence.
+    const uint32_t m = static_cast<uint32_t>(H.numEdges());
+    std::vector<uint32_t> pins(H.pins.begin(), H.pins.end());
+    std::vector<uint32_t> size(m);
+    std::vector<uint32_t> degreeCount(H.n + 1, 0);
+    PinDedup dedup(H.n);
+    for (uint32_t e = 0; e < m; ++e) {
+        uint32_t *first = pins.data() + H.offsets[e];
+        size[e] = H.weight(e) ? static_cast<uint32_t>(dedup.sortUnique(first, H.edgeSize(e))) : 0;
+        if (size[e] >= 2)
+            for (uint32_t i = 0; i < size[e]; ++i)
+                ++degreeCount[first[i] + 1];
+    }
+    std::partial_sum(degreeCount.begin(), degreeCount.end(), degreeCount.begin());
+    std::vector<uint32_t> incident(degreeCount.back());
+    std::vector<uint32_t> cursor(degreeCount.begin(), degreeCount.end() - 1);
+    for (uint32_t e = 0; e < m; ++e)
+        if (size[e] >= 2)
+            for (uint32_t i = 0; i < size[e]; ++i)
+                incident[cursor[pins[H.offsets[e] + i]]++] = e;
+    auto edgesOf = [&](uint32_t v) { return std::span<const uint32_t>(incident.data() + degreeCount[v], incident.data() + degreeCount[v + 1]); };
+    auto edgePins = [&](uint32_t e) { return std::span<const uint32_t>(pins.data() + H.offsets[e], size[e]); };
+
+    uint64_t lightest = std::numeric_limits<uint64_t>::max();
+    uint32_t lightestVertex = 0;
+    for (uint32_t v = 0; v < H.n; ++v) {
+        uint64_t degree = 0;
+        for (uint32_t e : edgesOf(v))
+            degree += H.weight(e);
+        if (degree < lightest) {
+            lightest = degree;
+            lightestVertex = v;
+        }
+    }
+    std::vector<bool> side(H.n, false);
+    side[lightestVertex] = true;
+    bounds.offer(lightest, side);
+
+    // inSide[e] counts the pins of e on the growing (or the `true`) side.
+    std::vector<uint32_t> inSide(m);
+    std::vector<uint32_t> order;
+    order.reserve(H.n);
+    AddressableMaxHeap queue;
+    std::mt19937_64 rng(splitmix64(options.seed));
+    for (uint32_t run = 0; run < options.greedyRuns && !bounds.exact(); ++run) {
+        const uint32_t start = run == 0 ? 0 : static_cast<uint32_t>(rng() % H.n);
+        queue.reset(H.n, 0);
+        for (uint32_t v = 0; v < H.n; ++v)
+            queue.push(v, v == start);
+        std::fill(inSide.begin(), inSide.end(), 0);
+        order.clear();
+        uint64_t cut = 0, best = std::numeric_limits<uint64_t>::max();
+        size_t bestPrefix = 0;
+        while (order.size() + 1 < H.n) {
+            const uint32_t v = queue.popMax().first;
+            order.push_back(v);
+            for (uint32_t e : edgesOf(v)) {
+                if (inSide[e]++ == 0) {
+                    cut += H.weight(e);
+                    for (uint32_t u : edgePins(e))
+                        if (queue.contains(u))
+                            queue.increase(u, H.weight(e));
+                }
+                if (inSide[e] == size[e])
+                    cut -= H.weight(e);
+            }
+            if (cut < best) {
+                best = cut;
+                bestPrefix = order.size();
+            }
+        }
+        if (best < bounds.upper) {
+            side.assign(H.n, false);
+            for (size_t i = 0; i < bestPrefix; ++i)
+                side[order[i]] = true;
+            bounds.offer(best, side);
+        }
+    }
+
+    // Label propagation: a vertex switches sides while that lowers the cut and
+    // leaves its old side nonempty.
+    side = bounds.side;
+    uint64_t cut = bounds.upper;
+    uint32_t trueCount = static_cast<uint32_t>(std::count(side.begin(), side.end(), true));
+    std::fill(inSide.begin(), inSide.end(), 0);
+    for (uint32_t e = 0; e < m; ++e)
+        for (uint32_t u : edgePins(e))
+            inSide[e] += side[u];
+    order.resize(H.n);
+    std::iota(order.begin(), order.end(), 0u);
+    for (uint32_t round = 0; round < options.refineRounds && !bounds.exact(); ++round) {
+        std::shuffle(order.begin(), order.end(), rng);
+        bool moved = false;
+        for (uint32_t v : order) {
+            if ((side[v] ? trueCount : H.n - trueCount) <= 1)
+                continue;
+            int64_t gain = 0;
+            for (uint32_t e : edgesOf(v)) {
+                const uint32_t own = side[v] ? inSide[e] : size[e] - inSide[e];
+                if (own == 1)
+                    gain += H.weight(e);
+                else if (own == size[e])
+                    gain -= H.weight(e);
+            }
+            if (gain <= 0)
+                continue;
+            side[v] = !side[v];
+            for (uint32_t e : edgesOf(v))
+                inSide[e] += side[v] ? 1 : -1;
+            trueCount += side[v] ? 1 : -1;
+            cut -= static_cast<uint64_t>(gain);
+            moved = true;
+        }
+        if (!moved)
+            break;
+        bounds.offer(cut, side);
+    }
+    return bounds;
+}
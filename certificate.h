@@ -0,0 +1,96 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "max_queue.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// k-trimmed certificate (Chekuri and Xu) from one maximum adjacency ordering of H.
+// When an edge is first reached, through its head (its earliest vertex in the
+// ordering), it keeps the head plus every later vertex whose already reached
+// edges weigh less than k in total. Trimming only removes pins, so no cut grows,
+// and every cut of H keeps at least min(its value, k). Each vertex keeps pins of
+// edges until its kept weight reaches k, so with integer weights it keeps at most k
+// of them. Zero-weight edges cut nothing and are left out, which keeps that O(k n).
+inline Hypergraph sparseCertificate(const Hypergraph &H, uint64_t k) {
+    const uint32_t n = H.n;
+    const size_t m = H.numEdges();
+
+    std::vector<uint64_t> incidenceOffsets(n + 1, 0);
+    for (size_t e = 0; e < m; ++e)
+        for (uint32_t v : H.edgePins(e))
+            ++incidenceOffsets[v + 1];
+    for (uint32_t v = 0; v < n; ++v)
+        incidenceOffsets[v + 1] += incidenceOffsets[v];
+    std::vector<uint32_t> incidence(incidenceOffsets[n]);
+    {
+        std::vector<uint64_t> fill(incidenceOffsets.begin(), incidenceOffsets.end() - 1);
+        for (size_t e = 0; e < m; ++e)
+            for (uint32_t v : H.edgePins(e))
+                incidence[fill[v]++] = static_cast<uint32_t>(e);
+    }
+
+    uint64_t totalWeight = 0;
+    for (size_t e = 0; e < m; ++e)
+        totalWeight += H.weight(e);
+
+    AddressableMaxHeap queue;
+    queue.reset(n, totalWeight);
+    for (uint32_t v = 0; v < n; ++v)
+        queue.push(v, 0);
+
+    std::vector<uint64_t> kept(n, 0);
+    std::vector<bool> reached(m, false);
+    std::vector<uint32_t> stamp(n, std::numeric_limits<uint32_t>::max());
+    std::vector<uint32_t> edgeVertices;
+
+    Hypergraph C;
+    C.n = n;
+    C.reserve(m, std::min<uint64_t>(H.numPins(), std::min<uint64_t>(k, totalWeight) * n + m));
+    while (!queue.empty()) {
+        const uint32_t head = queue.popMax().first;
+        for (uint64_t i = incidenceOffsets[head]; i < incidenceOffsets[head + 1]; ++i) {
+            const uint32_t e = incidence[i];
+            if (reached[e])
+                continue;
+            reached[e] = true;
+            const uint32_t w = H.weight(e);
+            if (w == 0)
+                continue;
+            edgeVertices.assign(1, head);
+            stamp[head] = e;
+            for (uint32_t v : H.edgePins(e)) {
+                if (stamp[v] == e || !queue.contains(v))
+                    continue;
+                stamp[v] = e;
+                queue.increase(v, w);
+                if (kept[v] < k) {
+                    kept[v] += w;
+                    edgeVertices.push_back(v);
+                }
+            }
+            if (edgeVertices.size() > 1)
+                C.addEdge(edgeVertices, w);
+        }
+    }
+    return C;
+}
+
+// Exact min cut through certificates for a doubling guess k: if the certificate's
+// min cut is below k it equals the min cut of H, otherwise the min cut of H is at
+// least k and k doubles. `solve` maps a Hypergraph to its min cut value, e.g.
+//   certifiedMinCut(H, [](const Hypergraph &G) { return deterministicMinCut(G); })
+template <class Solve>
+uint64_t certifiedMinCut(const Hypergraph &H, Solve &&solve, uint64_t initialGuess = 1) {
+    if (H.n <= 1)
+        return 0;
+    for (uint64_t k = std::max<uint64_t>(initialGuess, 1);; k *= 2) {
+        const Hypergraph C = sparseCertificate(H, k);
+        // Once k covers every pin the certificate is H itself, up to dropped single-pin edges.
+        const uint64_t cut = solve(C);
+        if (cut < k || C.numPins() == H.numPins())
+            return cut;
+    }
+}
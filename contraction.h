@@ -0,0 +1,328 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "instrument.h"
+#include "sampler.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Union-find without path compression, so every union can be undone in LIFO order.
+class RollbackDSU {
+    std::pmr::vector<uint32_t> parent;
+    std::pmr::vector<uint32_t> size;
+    std::pmr::vector<uint32_t> history;
+    uint32_t num_components;
+
+  public:
+    explicit RollbackDSU(uint32_t n, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : parent(n, resource), size(n, 1, resource), history(resource), num_components(n) {
+        std::iota(parent.begin(), parent.end(), 0u);
+        history.reserve(n);
+    }
+
+    RollbackDSU(const RollbackDSU &other, std::pmr::memory_resource *resource)
+        : parent(other.parent, resource), size(other.size, resource), history(other.history, resource), num_components(other.num_components) {}
+
+    uint32_t find(uint32_t x) const noexcept {
+        while (parent[x] != x)
+            x = parent[x];
+        return x;
+    }
+
+    bool unite(uint32_t a, uint32_t b) noexcept {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+            return false;
+        if (size[a] < size[b])
+            std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+        history.push_back(b);
+        --num_components;
+        return true;
+    }
+
+    size_t version() const noexcept { return history.size(); }
+
+    void rollback(size_t version) noexcept {
+        while (history.size() > version) {
+            uint32_t b = history.back();
+            history.pop_back();
+            size[parent[b]] -= size[b];
+            parent[b] = b;
+            ++num_components;
+        }
+    }
+
+    uint32_t components() const noexcept { return num_components; }
+};
+
+// Contracted view of a hypergraph that is modified in place and restored with
+// rollback(). Vertices are merged through a RollbackDSU, and every live edge keeps
+// its pins equal to their current roots: a merge walks the members of the smaller
+// side and relabels only the live edges incident to them, updating their sizes,
+// with every write logged so a rollback can restore it. Union by size moves each
+// vertex O(log n) times along a contraction sequence, instead of rescanning every
+// pin per level, and getKSpanning() visits only the edges forEachSpanCandidate()
+// names rather than every live edge. Edges leave the live set when they are contracted, collapse to one
+// vertex, or move into the cut; the sampler tracks live edge weights for O(log m)
+// weighted draws. The cut is a stack of edge ids with a running 64-bit weight, so
+// committing an edge and undoing it are both O(1). All working storage comes
+// from one memory resource, so a state can be cloned into a task's arena.
+class ContractionState {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    const Hypergraph &H;
+    RollbackDSU dsu;
+    EdgeSampler sampler;
+    std::pmr::vector<uint32_t> pins;
+    std::pmr::vector<uint32_t> live;
+    std::pmr::vector<uint32_t> position;
+    std::pmr::vector<uint32_t> sizes;
+    std::pmr::vector<uint32_t> stamp;
+    std::pmr::vector<uint32_t> edgeStamp;
+    // Vertex -> incident edges of H, CSR-style.
+    std::pmr::vector<uint64_t> incidenceOffsets;
+    std::pmr::vector<uint32_t> incidentEdges;
+    // Members of each component as a list from its root: next links, tail at the root.
+    std::pmr::vector<uint32_t> next;
+    std::pmr::vector<uint32_t> tail;
+    // Edges by decreasing pin count, which bounds their size.
+    std::pmr::vector<uint32_t> bySize;
+    std::pmr::vector<std::pair<uint64_t, uint32_t>> pinLog;
+    // (edge, size before the write). Entries from sizesSeen on are the edges
+    // resized since the last forEachSpanCandidate().
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> sizeLog;
+    size_t sizesSeen = 0;
+    // (winner, its tail before the merge), one per union.
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> mergeLog;
+    std::pmr::vector<uint32_t> cut;
+    uint64_t cutTotal = 0;
+    // Scratch for forEachLiveEdgeDense(); dense is only read where stamp is current.
+    std::pmr::vector<uint32_t> dense;
+    std::pmr::vector<uint32_t> denseEdge;
+    uint32_t epoch = 0;
+    uint32_t numLive;
+
+    void nextEpoch() {
+        if (++epoch == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            std::fill(edgeStamp.begin(), edgeStamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    bool isLive(uint32_t e) const noexcept { return position[e] < numLive; }
+
+    // Appends the members of loser to winner and relabels the live edges they touch.
+    void merge(uint32_t winner, uint32_t loser) {
+        mergeLog.emplace_back(winner, tail[winner]);
+        next[tail[winner]] = loser;
+        tail[winner] = tail[loser];
+        nextEpoch();
+        for (uint32_t v = loser; v != NONE; v = next[v]) {
+            for (uint64_t i = incidenceOffsets[v]; i < incidenceOffsets[v + 1]; ++i) {
+                const uint32_t e = incidentEdges[i];
+                if (edgeStamp[e] == epoch || !isLive(e))
+                    continue;
+                edgeStamp[e] = epoch;
+                bool hasWinner = false;
+                for (uint64_t j = H.offsets[e]; j < H.offsets[e + 1]; ++j) {
+                    if (pins[j] == winner) {
+                        hasWinner = true;
+                    } else if (pins[j] == loser) {
+                        pinLog.emplace_back(j, loser);
+                        pins[j] = winner;
+                    }
+                }
+                if (hasWinner) {
+                    sizeLog.emplace_back(e, sizes[e]);
+                    --sizes[e];
+                }
+            }
+        }
+    }
+
+  public:
+    struct Checkpoint {
+        size_t unions;
+        size_t pinWrites;
+        size_t sizeWrites;
+        size_t sizesSeen;
+        size_t weightUpdates;
+        size_t cutSize;
+        uint64_t cutWeight;
+        uint32_t numLive;
+    };
+
+    explicit ContractionState(const Hypergraph &H, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : H(H), dsu(H.n, resource), sampler(std::span<const uint32_t>(H.weights.data(), H.weights.size()), resource),
+          pins(H.pins.begin(), H.pins.end(), resource), live(H.numEdges(), resource), position(H.numEdges(), resource), sizes(H.numEdges(), resource),
+          stamp(H.n, 0, resource), edgeStamp(H.numEdges(), 0, resource), incidenceOffsets(H.n + 1, 0, resource), incidentEdges(resource),
+          next(H.n, NONE, resource), tail(H.n, resource), bySize(H.numEdges(), resource), pinLog(resource), sizeLog(resource), mergeLog(resource),
+          cut(resource), dense(H.n, resource), denseEdge(resource), numLive(static_cast<uint32_t>(H.numEdges())) {
+        std::iota(live.begin(), live.end(), 0u);
+        std::iota(position.begin(), position.end(), 0u);
+        std::iota(tail.begin(), tail.end(), 0u);
+        // Each edge is listed once per distinct pin, and its size is that count.
+        for (uint32_t e = 0; e < H.numEdges(); ++e) {
+            nextEpoch();
+            for (uint32_t v : H.edgePins(e)) {
+                if (stamp[v] != epoch) {
+                    stamp[v] = epoch;
+                    ++incidenceOffsets[v + 1];
+                    ++sizes[e];
+                }
+            }
+            // Logged unchanged, so the first forEachSpanCandidate() drops it.
+            if (sizes[e] <= 1)
+                sizeLog.emplace_back(e, sizes[e]);
+        }
+        std::partial_sum(incidenceOffsets.begin(), incidenceOffsets.end(), incidenceOffsets.begin());
+        incidentEdges.resize(incidenceOffsets.back());
+        std::pmr::vector<uint64_t> cursor(incidenceOffsets.begin(), incidenceOffsets.end() - 1, resource);
+        for (uint32_t e = 0; e < H.numEdges(); ++e) {
+            nextEpoch();
+            for (uint32_t v : H.edgePins(e)) {
+                if (stamp[v] != epoch) {
+                    stamp[v] = epoch;
+                    incidentEdges[cursor[v]++] = e;
+                }
+            }
+        }
+        std::iota(bySize.begin(), bySize.end(), 0u);
+        std::stable_sort(bySize.begin(), bySize.end(), [&](uint32_t a, uint32_t b) { return H.edgeSize(a) > H.edgeSize(b); });
+    }
+
+    ContractionState(const ContractionState &other, std::pmr::memory_resource *resource)
+        : H(other.H), dsu(other.dsu, resource), sampler(other.sampler, resource), pins(other.pins, resource), live(other.live, resource),
+          position(other.position, resource), sizes(other.sizes, resource), stamp(other.stamp, resource), edgeStamp(other.edgeStamp, resource),
+          incidenceOffsets(other.incidenceOffsets, resource), incidentEdges(other.incidentEdges, resource), next(other.next, resource),
+          tail(other.tail, resource), bySize(other.bySize, resource), pinLog(other.pinLog, resource), sizeLog(other.sizeLog, resource),
+          sizesSeen(other.sizesSeen), mergeLog(other.mergeLog, resource), cut(other.cut, resource), cutTotal(other.cutTotal),
+          dense(other.dense.size(), resource), denseEdge(resource), epoch(other.epoch), numLive(other.numLive) {}
+
+    const Hypergraph &graph() const noexcept { return H; }
+    uint32_t n() const noexcept { return dsu.components(); }
+    uint32_t numLiveEdges() const noexcept { return numLive; }
+    uint32_t liveEdge(uint32_t i) const noexcept { return live[i]; }
+    uint64_t liveWeight() const noexcept { return sampler.total(); }
+    const EdgeSampler &edgeSampler() const noexcept { return sampler; }
+    uint32_t weight(uint32_t e) const noexcept { return H.weight(e); }
+    std::span<const uint32_t> cutEdges() const noexcept { return cut; }
+    uint64_t cutWeight() const noexcept { return cutTotal; }
+
+    // Number of distinct contracted vertices in live edge e.
+    uint32_t edgeSize(uint32_t e) const noexcept { return sizes[e]; }
+    uint32_t currentSize(uint32_t e) const noexcept { return sizes[e]; }
+
+    uint32_t find(uint32_t v) const noexcept { return dsu.find(v); }
+
+    // Pins and sizes of live edges are kept current by contract().
+    void refresh() noexcept {}
+
+    // Calls f(e) for every live edge that can have size <= 1 or >= threshold:
+    // those resized since the last call and those whose original size reaches
+    // threshold. Sizes only shrink, so no other edge can. f may remove e.
+    template <class F>
+    void forEachSpanCandidate(uint32_t threshold, F &&f) {
+        for (; sizesSeen < sizeLog.size(); ++sizesSeen) {
+            const uint32_t e = sizeLog[sizesSeen].first;
+            if (isLive(e))
+                f(e);
+        }
+        for (uint32_t i = 0; i < bySize.size() && H.edgeSize(bySize[i]) >= threshold; ++i) {
+            if (isLive(bySize[i]))
+                f(bySize[i]);
+        }
+    }
+
+    // Calls f(e, ids) for every live edge, with its pins given as dense ids of the
+    // contracted vertices, numbered from 0 in order of first appearance. ids may
+    // repeat a vertex. Returns the number of distinct vertices seen.
+    template <class F>
+    uint32_t forEachLiveEdgeDense(F &&f) {
+        nextEpoch();
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < numLive; ++i) {
+            const uint32_t e = live[i];
+            denseEdge.clear();
+            for (uint64_t j = H.offsets[e]; j < H.offsets[e + 1]; ++j) {
+                const uint32_t root = pins[j];
+                if (stamp[root] != epoch) {
+                    stamp[root] = epoch;
+                    dense[root] = next++;
+                }
+                denseEdge.push_back(dense[root]);
+            }
+            f(e, std::span<const uint32_t>(denseEdge));
+        }
+        return next;
+    }
+
+    void removeEdge(uint32_t e) {
+        const uint32_t i = position[e];
+        const uint32_t last = live[--numLive];
+        live[i] = last;
+        position[last] = i;
+        live[numLive] = e;
+        position[e] = numLive;
+        sampler.set(e, 0);
+    }
+
+    // Drops e from the live set and commits it to the cut.
+    void cutEdge(uint32_t e) {
+        removeEdge(e);
+        cut.push_back(e);
+        cutTotal += H.weight(e);
+    }
+
+    // Merges all vertices of e into one and drops e from the live set. Once e is
+    // dropped its own pins are no longer relabelled, so they go through find().
+    void contract(uint32_t e) {
+        HMC_PROBE(Probe::Contract);
+        removeEdge(e);
+        for (uint64_t j = H.offsets[e] + 1; j < H.offsets[e + 1]; ++j) {
+            const uint32_t a = dsu.find(pins[H.offsets[e]]);
+            const uint32_t b = dsu.find(pins[j]);
+            if (!dsu.unite(a, b))
+                continue;
+            const uint32_t winner = dsu.find(a);
+            merge(winner, winner == a ? b : a);
+        }
+    }
+
+    Checkpoint checkpoint() const noexcept {
+        return {dsu.version(), pinLog.size(), sizeLog.size(), sizesSeen, sampler.checkpoint(), cut.size(), cutTotal, numLive};
+    }
+
+    void rollback(const Checkpoint &checkpoint) noexcept {
+        dsu.rollback(checkpoint.unions);
+        while (mergeLog.size() > checkpoint.unions) {
+            auto [winner, oldTail] = mergeLog.back();
+            mergeLog.pop_back();
+            next[oldTail] = NONE;
+            tail[winner] = oldTail;
+        }
+        while (pinLog.size() > checkpoint.pinWrites) {
+            pins[pinLog.back().first] = pinLog.back().second;
+            pinLog.pop_back();
+        }
+        while (sizeLog.size() > checkpoint.sizeWrites) {
+            sizes[sizeLog.back().first] = sizeLog.back().second;
+            sizeLog.pop_back();
+        }
+        sizesSeen = checkpoint.sizesSeen;
+        sampler.rollback(checkpoint.weightUpdates);
+        cut.resize(checkpoint.cutSize);
+        cutTotal = checkpoint.cutWeight;
+        numLive = checkpoint.numLive;
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+
+// Anytime controls shared by the solvers: a wall-clock deadline, a cancellation
+// token and a callback for improving cuts. Solvers poll expired() at coarse
+// intervals and return the best cut they have instead of throwing.
+struct SolveControl {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    std::stop_token stop;
+    // Called with every improvement of the best cut weight, never concurrently.
+    std::function<void(uint64_t)> onImprovement;
+
+    bool expired() const noexcept { return stop.stop_requested() || std::chrono::steady_clock::now() >= deadline; }
+
+    void improved(uint64_t cutWeight) const {
+        if (onImprovement)
+            onImprovement(cutWeight);
+    }
+
+    static SolveControl within(std::chrono::steady_clock::duration budget) { return {std::chrono::steady_clock::now() + budget, {}, {}}; }
+};
+
+// Checks a SolveControl every `interval` calls, so hot loops pay a counter
+// decrement rather than a clock read. Stays expired once it has fired.
+class StopPoll {
+    const SolveControl *control;
+    uint32_t interval;
+    uint32_t countdown;
+    bool fired = false;
+
+  public:
+    explicit StopPoll(const SolveControl *control, uint32_t interval = 1024) : control(control), interval(interval), countdown(interval) {}
+
+    bool operator()() noexcept {
+        if (fired || !control)
+            return fired;
+        if (--countdown)
+            return false;
+        countdown = interval;
+        return fired = control->expired();
+    }
+};
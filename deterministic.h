@@ -1,94 +1,349 @@
 #pragma once
 
+#include "bounds.h"
 #include "hypergraph.h"
+#include "max_queue.h"
+#include "parallel.h"
+#include "simd.h"
+#include "small_graph.h"
 #include <algorithm>
+#include <atomic>
 #include <limits>
 #include <numeric>
+#include <optional>
 #include <vector>
 #include "randomized.h"
 
-inline uint64_t deterministicMinCut(const Hypergraph& H) {
-    if (H.n <= 1 || H.edges.empty()) {
-        return 0;
-    }
+// Edges or vertices per parallelFor index in deterministicMinCut's parallel stages.
+inline constexpr uint32_t DETERMINISTIC_BLOCK = 1 << 12;
+// Merges of vertices with fewer incident edges are not worth splitting.
+inline constexpr size_t PARALLEL_MERGE_MIN_EDGES = 1 << 14;
+
+// The setup loop of deterministicMinCut on a pool: dedups every edge's pins in
+// place, then builds each incidence list with a counting pass and sorts it, so
+// the lists come out in edge order exactly as the sequential loop leaves them.
+// Returns the total edge weight.
+inline uint64_t buildIncidence(const Hypergraph &H, std::vector<uint32_t> &pins, std::vector<uint32_t> &edgeSize,
+                               std::vector<std::vector<uint32_t>> &incident, ThreadPool &pool) {
+    const uint32_t m = H.numEdges();
+    const size_t edgeBlocks = (m + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    const size_t vertexBlocks = (H.n + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    auto edgeRange = [&](size_t b) { return std::pair<uint32_t, uint32_t>(b * DETERMINISTIC_BLOCK, std::min<size_t>(m, (b + 1) * DETERMINISTIC_BLOCK)); };
+    auto vertexRange = [&](size_t b) { return std::pair<uint32_t, uint32_t>(b * DETERMINISTIC_BLOCK, std::min<size_t>(H.n, (b + 1) * DETERMINISTIC_BLOCK)); };
+
+    std::vector<std::optional<PinDedup>> dedup(pool.size());
+    std::vector<uint64_t> blockWeight(edgeBlocks, 0);
+    std::vector<uint32_t> degree(H.n, 0);
+    parallelFor(pool, edgeBlocks, [&](size_t b, unsigned slot) {
+        if (!dedup[slot])
+            dedup[slot].emplace(H.n);
+        auto [begin, end] = edgeRange(b);
+        for (uint32_t ei = begin; ei < end; ++ei) {
+            uint32_t *first = pins.data() + H.offsets[ei];
+            edgeSize[ei] = static_cast<uint32_t>(dedup[slot]->sortUnique(first, H.edgeSize(ei)));
+            if (edgeSize[ei] >= 2) {
+                for (uint32_t *it = first; it != first + edgeSize[ei]; ++it)
+                    std::atomic_ref(degree[*it]).fetch_add(1, std::memory_order_relaxed);
+            }
+            blockWeight[b] += H.weight(ei);
+        }
+    });
+    // degree becomes each list's fill cursor.
+    parallelFor(pool, vertexBlocks, [&](size_t b, unsigned) {
+        auto [begin, end] = vertexRange(b);
+        for (uint32_t v = begin; v < end; ++v) {
+            incident[v].resize(degree[v]);
+            degree[v] = 0;
+        }
+    });
+    parallelFor(pool, edgeBlocks, [&](size_t b, unsigned) {
+        auto [begin, end] = edgeRange(b);
+        for (uint32_t ei = begin; ei < end; ++ei) {
+            if (edgeSize[ei] < 2)
+                continue;
+            const uint32_t *first = pins.data() + H.offsets[ei];
+            for (const uint32_t *it = first; it != first + edgeSize[ei]; ++it)
+                incident[*it][std::atomic_ref(degree[*it]).fetch_add(1, std::memory_order_relaxed)] = ei;
+        }
+    });
+    parallelFor(pool, vertexBlocks, [&](size_t b, unsigned) {
+        auto [begin, end] = vertexRange(b);
+        for (uint32_t v = begin; v < end; ++v)
+            std::sort(incident[v].begin(), incident[v].end());
+    });
+    return std::accumulate(blockWeight.begin(), blockWeight.end(), uint64_t{0});
+}
 
-    DSU dsu(H.n);
-    uint64_t minCut = std::numeric_limits<uint64_t>::max();
-    const uint32_t m = H.edges.size();
+// lightestVertexCut with one minimum per vertex block, reduced in block order.
+inline std::pair<uint64_t, uint32_t> lightestVertexCut(const Hypergraph &H, const std::vector<std::vector<uint32_t>> &incident, ThreadPool &pool) {
+    const size_t blocks = (H.n + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    std::vector<std::pair<uint64_t, uint32_t>> best(blocks, {std::numeric_limits<uint64_t>::max(), 0});
+    parallelFor(pool, blocks, [&](size_t b, unsigned) {
+        for (uint32_t v = b * DETERMINISTIC_BLOCK; v < std::min<size_t>(H.n, (b + 1) * DETERMINISTIC_BLOCK); ++v) {
+            uint64_t degree = 0;
+            for (uint32_t ei : incident[v])
+                degree += H.weight(ei);
+            best[b] = std::min(best[b], {degree, v});
+        }
+    });
+    return *std::min_element(best.begin(), best.end());
+}
 
-    while (dsu.components() > 1) {
-        std::vector<uint32_t> reps;
-        for (uint32_t v = 0; v < H.n; ++v) {
-            if (dsu.find(v) == v) reps.push_back(v);
+// Queue picks the maximum adjacency ordering's next vertex: AddressableMaxHeap
+// (O(p log n) per phase) or BucketQueue (O(p + n + total edge weight) per phase).
+//
+// The contracted hypergraph is kept across phases: every edge holds its distinct
+// live vertices in its slice of `pins`, and every live vertex lists the edges
+// that still span at least two vertices. Merging s and t only touches their edges.
+// Graphs with at most SMALL_MIN_CUT_MAX_N vertices run on the bitset variant in small_graph.h.
+//
+// If side is given it receives one side of a minimum cut. Once control expires the
+// current phase is abandoned and the lightest cut seen so far is returned, at
+// worst the lightest single vertex, so the result is only exact if control had
+// not expired when the call returned.
+//
+// bounds, e.g. from cutBounds(), seed the best cut: every edge at least as heavy
+// as the best known cut is contracted before the first phase, and the phases stop
+// once a cut reaches bounds->lower (or 0). Without bounds the lightest vertex cut
+// seeds it. Within a phase, consecutive vertices whose connection reaches the best
+// cut are contracted along with s and t, so a tight bound also cuts the number of
+// phases.
+//
+// With threads > 1 (0 = all cores) the setup and the merges of high-degree
+// vertices run on a pool; the ordering itself stays sequential. The cut value
+// and side are the same for every thread count.
+template <class Queue = AddressableMaxHeap>
+inline uint64_t deterministicMinCut(const Hypergraph& H, std::vector<bool> *side = nullptr, const SolveControl *control = nullptr,
+                                    unsigned threads = 1, const CutBounds *bounds = nullptr) {
+    if (bounds && bounds->exact() && bounds->side.size() == H.n) {
+        if (side)
+            *side = bounds->side;
+        return bounds->upper;
+    }
+    if (H.n <= 1 || H.numEdges() == 0) {
+        if (side) {
+            side->assign(H.n, false);
+            if (H.n > 1)
+                (*side)[0] = true;
         }
+        return 0;
+    }
+    if (H.n <= SMALL_MIN_CUT_MAX_N) {
+        return dispatchSmall(H.n, [&](auto words) { return smallMinCut<words(), Queue>(H, side, control); });
+    }
 
-        if (reps.size() < 2) break;
-        std::vector<std::vector<uint32_t>> edgeReps(m);
-        std::vector<std::vector<uint32_t>> incident(H.n);
+    const uint32_t m = H.numEdges();
+    threads = ThreadPool::resolveThreads(threads);
+    std::optional<ThreadPool> pool;
+    if (threads > 1 && m >= 2 * DETERMINISTIC_BLOCK)
+        pool.emplace(threads);
 
+    HMC_PROBE_AS(setup, Probe::Setup);
+    std::vector<uint32_t> pins(H.pins.begin(), H.pins.end());
+    std::vector<uint32_t> edgeSize(m);
+    std::vector<std::vector<uint32_t>> incident(H.n);
+    uint64_t totalWeight = 0;
+    if (pool) {
+        totalWeight = buildIncidence(H, pins, edgeSize, incident, *pool);
+    } else {
+        PinDedup dedup(H.n);
         for (uint32_t ei = 0; ei < m; ++ei) {
-            for (uint32_t v : H.edges[ei].vertices) {
-                edgeReps[ei].push_back(dsu.find(v));
+            uint32_t *first = pins.data() + H.offsets[ei];
+            edgeSize[ei] = static_cast<uint32_t>(dedup.sortUnique(first, H.edgeSize(ei)));
+            if (edgeSize[ei] >= 2) {
+                for (uint32_t *it = first; it != first + edgeSize[ei]; ++it)
+                    incident[*it].push_back(ei);
             }
-            std::sort(edgeReps[ei].begin(), edgeReps[ei].end());
-            edgeReps[ei].erase(std::unique(edgeReps[ei].begin(), edgeReps[ei].end()),
-                               edgeReps[ei].end());
+            totalWeight += H.weight(ei);
+        }
+    }
+
+    std::vector<uint32_t> reps(H.n);
+    std::vector<uint32_t> repIndex(H.n);
+    // The vertex each merged-away vertex went into.
+    std::vector<uint32_t> mergedInto(H.n, std::numeric_limits<uint32_t>::max());
+    std::iota(reps.begin(), reps.end(), 0u);
+    std::iota(repIndex.begin(), repIndex.end(), 0u);
 
-            if (edgeReps[ei].size() >= 2) {
-                for (uint32_t r : edgeReps[ei]) {
-                    incident[r].push_back(ei);
+    std::vector<uint32_t> mark(m, 0);
+    uint32_t epoch = 0;
+    std::vector<bool> edgeCrossed(m, false);
+    std::vector<uint32_t> crossed;
+    crossed.reserve(m);
+
+    Queue queue;
+    queue.reset(H.n, totalWeight);
+    HMC_ADD_BYTES(pins.size() * 4 + edgeSize.size() * 4 + H.numPins() * 4 + reps.size() * 8 + mark.size() * 4 + crossed.capacity() * 4);
+    HMC_PROBE_STOP(setup);
+
+    std::vector<std::pair<uint32_t, uint32_t>> merges;
+    // Pairs found safe to contract during the current phase.
+    std::vector<std::pair<uint32_t, uint32_t>> pendant;
+
+    // Relabels a to b in one of a's edges; false if the edge already contains b.
+    auto relabel = [&](uint32_t ei, uint32_t a, uint32_t b) {
+        uint32_t *slice = pins.data() + H.offsets[ei];
+        uint32_t i = 0;
+        while (slice[i] != a)
+            ++i;
+        if (mark[ei] == epoch) {
+            slice[i] = slice[--edgeSize[ei]];
+            return false;
+        }
+        slice[i] = b;
+        return true;
+    };
+
+    // Merges vertex a into vertex b. Every edge of a is touched by exactly one
+    // block, and the edges gaining b are appended in the sequential order.
+    auto merge = [&](uint32_t a, uint32_t b) {
+        HMC_PROBE(Probe::PhaseRebuild);
+        ++epoch;
+        bool collapsed = false;
+        if (pool && incident[a].size() >= PARALLEL_MERGE_MIN_EDGES) {
+            const std::vector<uint32_t> &edges = incident[a];
+            const size_t blocks = (edges.size() + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+            const std::vector<uint32_t> &marked = incident[b];
+            parallelFor(*pool, (marked.size() + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK, [&](size_t blk, unsigned) {
+                for (size_t i = blk * DETERMINISTIC_BLOCK; i < std::min(marked.size(), (blk + 1) * DETERMINISTIC_BLOCK); ++i)
+                    mark[marked[i]] = epoch;
+            });
+            std::vector<std::vector<uint32_t>> gained(blocks);
+            std::vector<char> blockCollapsed(blocks, false);
+            parallelFor(*pool, blocks, [&](size_t blk, unsigned) {
+                for (size_t i = blk * DETERMINISTIC_BLOCK; i < std::min(edges.size(), (blk + 1) * DETERMINISTIC_BLOCK); ++i) {
+                    if (relabel(edges[i], a, b))
+                        gained[blk].push_back(edges[i]);
+                    else
+                        blockCollapsed[blk] |= edgeSize[edges[i]] < 2;
                 }
+            });
+            for (size_t blk = 0; blk < blocks; ++blk) {
+                incident[b].insert(incident[b].end(), gained[blk].begin(), gained[blk].end());
+                collapsed |= blockCollapsed[blk];
+            }
+        } else {
+            for (uint32_t ei : incident[b])
+                mark[ei] = epoch;
+            for (uint32_t ei : incident[a]) {
+                if (relabel(ei, a, b))
+                    incident[b].push_back(ei);
+                else
+                    collapsed |= edgeSize[ei] < 2;
             }
         }
+        incident[a].clear();
+        incident[a].shrink_to_fit();
+        if (collapsed) {
+            std::erase_if(incident[b], [&](uint32_t ei) { return edgeSize[ei] < 2; });
+        }
 
-        std::vector<uint64_t> connectivity(H.n, 0);
-        std::vector<bool> inA(H.n, false);
-        std::vector<bool> edgeCrossed(m, false);
+        const uint32_t last = reps.back();
+        reps[repIndex[a]] = last;
+        repIndex[last] = repIndex[a];
+        reps.pop_back();
+        mergedInto[a] = b;
+    };
 
-        inA[reps[0]] = true;
+    auto live = [&](uint32_t v) {
+        while (mergedInto[v] != std::numeric_limits<uint32_t>::max())
+            v = mergedInto[v];
+        return v;
+    };
 
-        for (uint32_t ei : incident[reps[0]]) {
-            edgeCrossed[ei] = true;
-            uint64_t w = H.edges[ei].weight;
-            for (uint32_t r : edgeReps[ei]) {
-                if (!inA[r]) connectivity[r] += w;
-            }
+    // Merges the current vertices containing x and y, the smaller into the larger.
+    auto mergePair = [&](uint32_t x, uint32_t y) {
+        x = live(x);
+        y = live(y);
+        if (x == y)
+            return;
+        merges.emplace_back(x, y);
+        if (incident[x].size() <= incident[y].size())
+            merge(x, y);
+        else
+            merge(y, x);
+    };
+
+    auto [minCut, bestT] = pool ? lightestVertexCut(H, incident, *pool) : lightestVertexCut(H, incident);
+    size_t bestPhase = 0;
+    const uint64_t lower = bounds ? bounds->lower : 0;
+    bool seeded = bounds && bounds->upper < minCut && bounds->side.size() == H.n;
+    if (seeded)
+        minCut = bounds->upper;
+    StopPoll expired(control);
+    if (control)
+        control->improved(minCut);
+
+    // A cut crossing an edge this heavy is no lighter than minCut.
+    if (minCut > lower) {
+        HMC_PROBE(Probe::PhaseRebuild);
+        for (uint32_t ei = 0; ei < m; ++ei) {
+            if (H.weight(ei) < minCut)
+                continue;
+            const uint32_t *slice = pins.data() + H.offsets[ei];
+            while (edgeSize[ei] >= 2)
+                mergePair(slice[0], slice[1]);
         }
+    }
+
+    while (reps.size() > 1 && minCut > lower) {
+        HMC_PROBE_AS(rebuild, Probe::PhaseRebuild);
+        for (uint32_t v : reps)
+            queue.push(v, 0);
+        HMC_PROBE_STOP(rebuild);
 
         uint32_t s = reps[0], t = reps[0];
         uint64_t cutOfPhase = 0;
 
-        for (size_t step = 1; step < reps.size(); ++step) {
-            uint32_t best = 0;
-            uint64_t bestConn = 0;
-            bool found = false;
-            for (uint32_t v : reps) {
-                if (!inA[v] && (!found || connectivity[v] > bestConn)) {
-                    best = v;
-                    bestConn = connectivity[v];
-                    found = true;
-                }
-            }
+        HMC_PROBE_AS(ordering, Probe::MaOrdering);
+        while (!queue.empty()) {
+            if (expired())
+                break;
+            auto [best, bestConn] = queue.popMax();
 
             s = t;
             t = best;
             cutOfPhase = bestConn;
-            inA[best] = true;
+            // Every cut separating consecutive vertices of the ordering crosses at
+            // least the later one's key, so a key reaching minCut makes them safe
+            // to contract after the phase.
+            if (bestConn >= minCut && s != t)
+                pendant.emplace_back(s, t);
 
             for (uint32_t ei : incident[best]) {
                 if (!edgeCrossed[ei]) {
                     edgeCrossed[ei] = true;
-                    uint64_t w = H.edges[ei].weight;
-                    for (uint32_t r : edgeReps[ei]) {
-                        if (!inA[r]) connectivity[r] += w;
+                    crossed.push_back(ei);
+                    uint64_t w = H.weight(ei);
+                    const uint32_t *slice = pins.data() + H.offsets[ei];
+                    for (uint32_t j = 0; j < edgeSize[ei]; ++j) {
+                        if (queue.contains(slice[j])) queue.increase(slice[j], w);
                     }
                 }
             }
         }
+        HMC_PROBE_STOP(ordering);
+        if (expired())
+            break;
+        for (uint32_t ei : crossed)
+            edgeCrossed[ei] = false;
+        crossed.clear();
 
-        minCut = std::min(minCut, cutOfPhase);
-        dsu.unite(s, t);
+        if (cutOfPhase < minCut) {
+            minCut = cutOfPhase;
+            bestPhase = merges.size();
+            bestT = t;
+            seeded = false;
+            if (control)
+                control->improved(minCut);
+        }
+        mergePair(s, t);
+        for (auto [x, y] : pendant)
+            mergePair(x, y);
+        pendant.clear();
     }
 
+    if (side)
+        *side = seeded ? bounds->side : phaseCutSide(H.n, merges, bestPhase, bestT);
     return minCut;
-}
\ No newline at end of file
+}
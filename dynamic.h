@@ -0,0 +1,206 @@
+#pragma once
+
+#include "deterministic.h"
+#include "hypergraph.h"
+#include "reduction.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// How DynamicMinCut::minCut() answered the last query.
+enum class RequeryPath {
+    // Nothing changed since the previous query.
+    Cached,
+    // The previous cut still meets the lower bound; no solve.
+    Bound,
+    // The previous kernel was solved again and its contractions were still safe.
+    Kernel,
+    // Kernelized and solved from scratch, seeded with the previous cut.
+    Full,
+};
+
+// Minimum 2-cut of a hypergraph under batches of edge insertions, deletions and
+// reweights. Updates are buffered and applied by the next minCut() call, which
+// reuses the previous solve:
+//   - Every update moves a cut by at most the weight it removes, so the previous
+//     minimum minus the total decrease since then is a lower bound, and the
+//     previous side, kept up to date per update, is an upper bound. When they
+//     meet the answer is known without a solve.
+//   - Every contraction of the previous kernel separated vertices whose cuts
+//     weighed at least its bound, and they have lost at most the decrease since.
+//     The updated graph is projected onto the old kernel and solved there; the
+//     result stands if it does not exceed that floor.
+//   - Otherwise kernelize() runs again with the previous side as its initial
+//     bound, so every edge at least as heavy as that cut is contracted upfront.
+// Both solves stop as soon as they reach the lower bound.
+//
+//   DynamicMinCut cut(std::move(H));
+//   cut.minCut();
+//   cut.reweightEdge(e, 0);
+//   uint32_t f = cut.insertEdge(pins, 7);
+//   cut.minCut();
+//
+// Edge ids are those of H, then one per insertion in order. Erased edges keep
+// their id and stay in the CSR arrays with weight zero.
+class DynamicMinCut {
+    Hypergraph H;
+    unsigned threads;
+
+    bool solved = false;
+    bool dirty = true;
+    RequeryPath path = RequeryPath::Full;
+    uint64_t cut = 0;
+    std::vector<bool> side;
+    // Current weight of the cut given by side.
+    uint64_t sideWeight = 0;
+    // Weight removed since the last exact answer, and since the kernel was built.
+    uint64_t decrease = 0;
+    uint64_t kernelDecrease = 0;
+
+    std::vector<uint32_t> vertexMap;
+    uint32_t kernelN = 0;
+    uint64_t kernelBound = 0;
+
+    bool crosses(uint32_t e) const {
+        auto pins = H.edgePins(e);
+        return std::any_of(pins.begin(), pins.end(), [&](uint32_t v) { return side[v] != side[pins[0]]; });
+    }
+
+    void checkEdge(uint32_t e) const {
+        if (e >= H.numEdges())
+            throw std::runtime_error("no edge " + std::to_string(e));
+    }
+
+    void changeWeight(uint32_t e, uint32_t w) {
+        const uint32_t old = H.weight(e);
+        if (old > w) {
+            decrease += old - w;
+            kernelDecrease += old - w;
+        }
+        if (solved && crosses(e))
+            sideWeight = sideWeight - old + w;
+        H.weights.mutableData()[e] = w;
+        dirty = true;
+    }
+
+    // No cut is lighter than the last answer minus the weight removed since.
+    CutBounds knownBounds() const {
+        CutBounds bounds;
+        if (solved)
+            bounds.lower = cut > decrease ? cut - decrease : 0;
+        return bounds;
+    }
+
+    void accept(uint64_t value, RequeryPath how) {
+        cut = sideWeight = value;
+        decrease = 0;
+        solved = true;
+        dirty = false;
+        path = how;
+    }
+
+  public:
+    explicit DynamicMinCut(Hypergraph graph, unsigned threads = 1) : H(std::move(graph)), threads(threads) {
+        H.incidenceOffsets.clear();
+        H.incidentEdges.clear();
+    }
+
+    const Hypergraph &graph() const noexcept { return H; }
+    RequeryPath lastPath() const noexcept { return path; }
+
+    uint32_t insertEdge(std::span<const uint32_t> pins, uint32_t weight) {
+        for (uint32_t v : pins)
+            if (v >= H.n)
+                throw std::runtime_error("pin " + std::to_string(v) + " out of range");
+        const uint32_t e = static_cast<uint32_t>(H.numEdges());
+        H.addEdge(pins, weight);
+        if (solved && crosses(e))
+            sideWeight += weight;
+        dirty = true;
+        return e;
+    }
+
+    void eraseEdge(uint32_t e) {
+        checkEdge(e);
+        changeWeight(e, 0);
+    }
+
+    void reweightEdge(uint32_t e, uint32_t weight) {
+        checkEdge(e);
+        changeWeight(e, weight);
+    }
+
+    // Applies the buffered updates and returns the minimum cut weight; side, if
+    // given, receives one side of a minimum cut.
+    uint64_t minCut(std::vector<bool> *sideOut = nullptr) {
+        if (!dirty) {
+            path = RequeryPath::Cached;
+        } else if (H.n <= 1) {
+            side.assign(H.n, false);
+            accept(0, RequeryPath::Full);
+        } else if (solved && sideWeight == knownBounds().lower) {
+            accept(sideWeight, RequeryPath::Bound);
+        } else if (!solveKernel()) {
+            solveFull();
+        }
+        if (sideOut)
+            *sideOut = side;
+        return cut;
+    }
+
+  private:
+    bool solveKernel() {
+        if (!solved || kernelN <= 1)
+            return false;
+        const uint64_t floor = kernelBound > kernelDecrease ? kernelBound - kernelDecrease : 0;
+        const Hypergraph Q = mergeParallelEdges(quotient(H, vertexMap, kernelN));
+        std::vector<bool> kernelSide;
+        const CutBounds bounds = knownBounds();
+        const uint64_t q = deterministicMinCut(Q, &kernelSide, nullptr, threads, &bounds);
+        if (std::min(q, sideWeight) > floor)
+            return false;
+        if (q < sideWeight) {
+            for (uint32_t v = 0; v < H.n; ++v)
+                side[v] = kernelSide[vertexMap[v]];
+        }
+        accept(std::min(q, sideWeight), RequeryPath::Kernel);
+        return true;
+    }
+
+    void solveFull() {
+        std::vector<uint32_t> seedSide;
+        uint64_t seed = std::numeric_limits<uint64_t>::max();
+        if (solved) {
+            seed = sideWeight;
+            for (uint32_t v = 0; v < H.n; ++v)
+                if (side[v])
+                    seedSide.push_back(v);
+        }
+        const CutBounds bounds = knownBounds();
+        Reduction r = kernelize(H, seed, std::move(seedSide));
+        uint64_t value = r.bound;
+        side.assign(H.n, false);
+        if (r.graph.n > 1) {
+            std::vector<bool> kernelSide;
+            const uint64_t q = deterministicMinCut(r.graph, &kernelSide, nullptr, threads, &bounds);
+            if (q < value) {
+                value = q;
+                side = r.liftPartition(kernelSide);
+            }
+        }
+        if (value == r.bound) {
+            for (uint32_t v : r.boundSide)
+                side[v] = true;
+        }
+        vertexMap = std::move(r.vertexMap);
+        kernelN = r.graph.n;
+        kernelBound = r.bound;
+        kernelDecrease = 0;
+        accept(value, RequeryPath::Full);
+    }
+};
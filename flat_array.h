@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Contiguous array that either owns its elements or borrows them from memory kept
+// alive by `backing` (e.g. a mapped cache file). Reads never copy; the first
+// mutation of a borrowed array copies it into owned storage.
+template <class T>
+class FlatArray {
+    std::vector<T> owned;
+    const T *ptr = nullptr;
+    size_t len = 0;
+    std::shared_ptr<const void> backing;
+
+    void sync() noexcept {
+        ptr = owned.data();
+        len = owned.size();
+    }
+
+    std::vector<T> &own() {
+        if (backing) {
+            owned.assign(ptr, ptr + len);
+            backing.reset();
+            sync();
+        }
+        return owned;
+    }
+
+  public:
+    using value_type = T;
+
+    FlatArray() = default;
+    FlatArray(std::initializer_list<T> init) : owned(init) { sync(); }
+    explicit FlatArray(std::vector<T> values) noexcept : owned(std::move(values)) { sync(); }
+    FlatArray(const FlatArray &other) : owned(other.owned), ptr(other.ptr), len(other.len), backing(other.backing) {
+        if (!backing)
+            sync();
+    }
+    FlatArray(FlatArray &&other) noexcept
+        : owned(std::move(other.owned)), ptr(other.ptr), len(other.len), backing(std::move(other.backing)) {
+        if (!backing)
+            sync();
+        other.sync();
+    }
+    FlatArray &operator=(FlatArray other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(FlatArray &other) noexcept {
+        owned.swap(other.owned);
+        std::swap(ptr, other.ptr);
+        std::swap(len, other.len);
+        backing.swap(other.backing);
+    }
+
+    static FlatArray borrow(const T *data, size_t size, std::shared_ptr<const void> keepAlive) {
+        FlatArray array;
+        array.ptr = data;
+        array.len = size;
+        array.backing = std::move(keepAlive);
+        return array;
+    }
+
+    bool borrowed() const noexcept { return static_cast<bool>(backing); }
+
+    size_t size() const noexcept { return len; }
+    bool empty() const noexcept { return len == 0; }
+    const T *data() const noexcept { return ptr; }
+    const T *begin() const noexcept { return ptr; }
+    const T *end() const noexcept { return ptr + len; }
+    const T &operator[](size_t i) const noexcept { return ptr[i]; }
+    const T &back() const noexcept { return ptr[len - 1]; }
+
+    T *mutableData() { return own().data(); }
+    T &operator[](size_t i) { return own()[i]; }
+
+    void push_back(const T &value) {
+        own().push_back(value);
+        sync();
+    }
+
+    template <class It>
+    void append(It first, It last) {
+        auto &storage = own();
+        storage.insert(storage.end(), first, last);
+        sync();
+    }
+
+    void reserve(size_t capacity) {
+        own().reserve(capacity);
+        sync();
+    }
+
+    void resize(size_t size) {
+        own().resize(size);
+        sync();
+    }
+
+    void resize(size_t size, const T &value) {
+        own().resize(size, value);
+        sync();
+    }
+
+    void assign(size_t size, const T &value) {
+        own().assign(size, value);
+        sync();
+    }
+
+    void clear() noexcept {
+        owned.clear();
+        backing.reset();
+        sync();
+    }
+};
@@ -0,0 +1,413 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Synthetic hypergraph families. Edges are generated in fixed blocks, each with
+// its own generator seeded from (seed, block), so a graph depends only on its
+// options and never on the thread count. plantCut joins two graphs into one
+// whose minimum cut is known by construction.
+
+inline constexpr size_t GENERATOR_BLOCK = 1 << 12;
+
+// Membership bitmap for the pins of the edge being drawn; clear() only touches
+// the words of the pins it is given, so an edge costs O(its size).
+class PinSet {
+    std::vector<uint64_t> bits;
+
+  public:
+    void ensure(uint32_t n) {
+        if (bits.size() < n / 64 + 1)
+            bits.resize(n / 64 + 1, 0);
+    }
+
+    // Returns false if v was already present.
+    bool insert(uint32_t v) noexcept {
+        const uint64_t bit = uint64_t{1} << (v & 63);
+        if (bits[v >> 6] & bit)
+            return false;
+        bits[v >> 6] |= bit;
+        return true;
+    }
+
+    void clear(std::span<const uint32_t> pins) noexcept {
+        for (uint32_t v : pins)
+            bits[v >> 6] = 0;
+    }
+};
+
+inline PinSet &threadPinSet(uint32_t n) {
+    thread_local PinSet set;
+    set.ensure(n);
+    return set;
+}
+
+// Floyd's algorithm: appends k distinct values from [0, n) to out with k draws.
+inline void sampleSubset(uint32_t n, uint32_t k, std::mt19937_64 &rng, std::vector<uint32_t> &out) {
+    PinSet &seen = threadPinSet(n);
+    const size_t first = out.size();
+    for (uint32_t j = n - k; j < n; ++j) {
+        const uint32_t t = std::uniform_int_distribution<uint32_t>(0, j)(rng);
+        out.push_back(seen.insert(t) ? t : (seen.insert(j), j));
+    }
+    seen.clear({out.data() + first, k});
+}
+
+// Hash of an edge's sorted pins; equal edges collide by construction, distinct
+// ones with probability 2^-64.
+inline uint64_t edgeFingerprint(std::span<const uint32_t> sortedPins) noexcept {
+    uint64_t h = splitmix64(sortedPins.size());
+    for (uint32_t v : sortedPins)
+        h = splitmix64(h ^ v);
+    return h;
+}
+
+// Walker's alias method: O(1) draws from a fixed discrete distribution. sample()
+// is const, so one table can serve every block.
+class AliasTable {
+    std::vector<double> prob;
+    std::vector<uint32_t> alias;
+
+  public:
+    explicit AliasTable(std::span<const double> weights) : prob(weights.size()), alias(weights.size()) {
+        const size_t n = weights.size();
+        double total = 0;
+        for (double w : weights)
+            total += w;
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            prob[i] = weights[i] * static_cast<double>(n) / total;
+            (prob[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            const uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            alias[s] = l;
+            prob[l] -= 1.0 - prob[s];
+            if (prob[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        for (uint32_t i : small)
+            prob[i] = 1.0;
+        for (uint32_t i : large)
+            prob[i] = 1.0;
+    }
+
+    uint32_t sample(std::mt19937_64 &rng) const {
+        const uint32_t i = std::uniform_int_distribution<uint32_t>(0, static_cast<uint32_t>(prob.size() - 1))(rng);
+        return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < prob[i] ? i : alias[i];
+    }
+};
+
+// P(size = s) proportional to s^-exponent on [minSize, maxSize].
+inline AliasTable powerLawSizes(uint32_t minSize, uint32_t maxSize, double exponent) {
+    std::vector<double> weights;
+    for (uint32_t s = minSize; s <= maxSize; ++s)
+        weights.push_back(std::pow(static_cast<double>(s), -exponent));
+    return AliasTable(weights);
+}
+
+// Generates edges [0, m) block by block on `threads` workers and assembles the
+// CSR arrays. make(rng, pins) appends one edge's pins and returns its weight; it
+// runs concurrently on different blocks.
+template <class Make>
+Hypergraph generateEdges(uint32_t n, uint64_t m, uint64_t seed, unsigned threads, Make &&make) {
+    struct Block {
+        std::vector<uint32_t> pins;
+        std::vector<uint64_t> ends;
+        std::vector<uint32_t> weights;
+    };
+    const size_t numBlocks = (m + GENERATOR_BLOCK - 1) / GENERATOR_BLOCK;
+    std::vector<Block> blocks(numBlocks);
+    ThreadPool pool(ThreadPool::resolveThreads(threads));
+    parallelFor(pool, numBlocks, [&](size_t b, unsigned) {
+        Block &block = blocks[b];
+        std::mt19937_64 rng(splitmix64(splitmix64(seed) + b));
+        const uint64_t count = std::min<uint64_t>(GENERATOR_BLOCK, m - b * GENERATOR_BLOCK);
+        block.ends.reserve(count);
+        block.weights.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            block.weights.push_back(make(rng, block.pins));
+            block.ends.push_back(block.pins.size());
+        }
+    });
+
+    std::vector<uint64_t> pinStart(numBlocks + 1, 0);
+    for (size_t b = 0; b < numBlocks; ++b)
+        pinStart[b + 1] = pinStart[b] + blocks[b].pins.size();
+    std::vector<uint64_t> offsets(m + 1, 0);
+    std::vector<uint32_t> pins(pinStart[numBlocks]);
+    std::vector<uint32_t> weights(m);
+    parallelFor(pool, numBlocks, [&](size_t b, unsigned) {
+        Block &block = blocks[b];
+        const size_t e0 = b * GENERATOR_BLOCK;
+        std::copy(block.pins.begin(), block.pins.end(), pins.begin() + pinStart[b]);
+        std::copy(block.weights.begin(), block.weights.end(), weights.begin() + e0);
+        for (size_t i = 0; i < block.ends.size(); ++i)
+            offsets[e0 + i + 1] = pinStart[b] + block.ends[i];
+        block = Block{};
+    });
+
+    Hypergraph H;
+    H.n = n;
+    H.offsets = FlatArray<uint64_t>(std::move(offsets));
+    H.pins = FlatArray<uint32_t>(std::move(pins));
+    H.weights = FlatArray<uint32_t>(std::move(weights));
+    return H;
+}
+
+struct UniformOptions {
+    uint32_t n = 1000;
+    uint64_t m = 2000;
+    uint32_t rank = 10;
+    uint32_t maxWeight = 100;
+    uint64_t seed = 0;
+    unsigned threads = 1;
+};
+
+// m distinct edges of exactly `rank` sorted pins with uniform [1, maxWeight]
+// weights, drawn in O(rank) per edge rather than by shuffling all n vertices.
+// Duplicates are found by sorting fingerprints and redrawn from a sequential
+// generator, which keeps the result independent of the thread count.
+inline Hypergraph uniformHypergraph(const UniformOptions &options) {
+    const uint32_t n = options.n, k = options.rank;
+    if (k == 0 || k > n || options.maxWeight == 0)
+        throw std::runtime_error("uniformHypergraph needs 1 <= rank <= n and maxWeight >= 1");
+    // C(n, i) grows with i up to n / 2, so the product can stop once it exceeds m.
+    double subsets = 1;
+    for (uint32_t i = 0; i < std::min(k, n - k) && subsets < 2.0 * options.m; ++i)
+        subsets = subsets * (n - i) / (i + 1);
+    if (subsets < static_cast<double>(options.m))
+        throw std::runtime_error("uniformHypergraph: fewer than m distinct edges of this rank exist");
+
+    auto draw = [&](std::mt19937_64 &rng, std::vector<uint32_t> &pins) {
+        const size_t first = pins.size();
+        sampleSubset(n, k, rng, pins);
+        std::sort(pins.begin() + first, pins.end());
+        return std::uniform_int_distribution<uint32_t>(1, options.maxWeight)(rng);
+    };
+    Hypergraph H = generateEdges(n, options.m, options.seed, options.threads, draw);
+
+    const uint64_t m = options.m;
+    std::vector<std::pair<uint64_t, uint64_t>> keyed(m);
+    for (uint64_t e = 0; e < m; ++e)
+        keyed[e] = {edgeFingerprint(H.edgePins(e)), e};
+    std::sort(keyed.begin(), keyed.end());
+    std::vector<uint64_t> duplicates;
+    for (uint64_t i = 1; i < m; ++i)
+        if (keyed[i].first == keyed[i - 1].first)
+            duplicates.push_back(keyed[i].second);
+    if (duplicates.empty())
+        return H;
+
+    std::vector<uint64_t> taken;
+    taken.reserve(m);
+    for (const auto &[fingerprint, e] : keyed)
+        taken.push_back(fingerprint);
+    std::vector<uint64_t> added;
+    std::sort(duplicates.begin(), duplicates.end());
+    std::mt19937_64 rng(splitmix64(options.seed ^ 0x5bd1e995u));
+    std::vector<uint32_t> edge;
+    uint32_t *pins = H.pins.mutableData();
+    for (uint64_t e : duplicates) {
+        uint64_t fingerprint;
+        do {
+            edge.clear();
+            sampleSubset(n, k, rng, edge);
+            std::sort(edge.begin(), edge.end());
+            fingerprint = edgeFingerprint(edge);
+        } while (std::binary_search(taken.begin(), taken.end(), fingerprint) || std::find(added.begin(), added.end(), fingerprint) != added.end());
+        added.push_back(fingerprint);
+        std::copy(edge.begin(), edge.end(), pins + H.offsets[e]);
+    }
+    return H;
+}
+
+struct PowerLawOptions {
+    uint32_t n = 1000;
+    uint64_t m = 2000;
+    // Vertex weights (v + 1)^(-1 / (degreeExponent - 1)) give degrees a power-law tail.
+    double degreeExponent = 2.5;
+    // P(edge size = s) proportional to s^-sizeExponent on [2, maxRank].
+    double sizeExponent = 2.5;
+    uint32_t maxRank = 32;
+    uint32_t maxWeight = 100;
+    uint64_t seed = 0;
+    unsigned threads = 1;
+};
+
+// HyperFF-style skew in both vertex degrees and edge sizes. HyperFF's forest-fire
+// burning is sequential, so pins are drawn Chung-Lu style instead: in proportion
+// to fixed vertex weights, with labels shuffled so degree is not tied to id.
+inline Hypergraph powerLawHypergraph(const PowerLawOptions &options) {
+    const uint32_t n = options.n;
+    if (n < 2 || options.maxWeight == 0 || options.degreeExponent <= 1.0)
+        throw std::runtime_error("powerLawHypergraph needs n >= 2, maxWeight >= 1 and degreeExponent > 1");
+    const uint32_t maxRank = std::clamp(options.maxRank, 2u, n);
+
+    std::vector<double> vertexWeights(n);
+    for (uint32_t v = 0; v < n; ++v)
+        vertexWeights[v] = std::pow(static_cast<double>(v + 1), -1.0 / (options.degreeExponent - 1.0));
+    const AliasTable vertices(vertexWeights);
+    const AliasTable sizes = powerLawSizes(2, maxRank, options.sizeExponent);
+    std::vector<uint32_t> label(n);
+    std::iota(label.begin(), label.end(), 0u);
+    std::shuffle(label.begin(), label.end(), std::mt19937_64(splitmix64(options.seed)));
+
+    return generateEdges(n, options.m, options.seed, options.threads, [&](std::mt19937_64 &rng, std::vector<uint32_t> &pins) {
+        const size_t first = pins.size();
+        const uint32_t size = 2 + sizes.sample(rng);
+        PinSet &seen = threadPinSet(n);
+        // Heavy vertices repeat; after a bounded number of rejections the rest is uniform.
+        for (uint32_t attempts = 0; pins.size() - first < size;) {
+            const uint32_t v = ++attempts <= 8 * size ? label[vertices.sample(rng)] : std::uniform_int_distribution<uint32_t>(0, n - 1)(rng);
+            if (seen.insert(v))
+                pins.push_back(v);
+        }
+        seen.clear({pins.data() + first, size});
+        return std::uniform_int_distribution<uint32_t>(1, options.maxWeight)(rng);
+    });
+}
+
+struct NetlistOptions {
+    uint32_t n = 1000;
+    uint64_t m = 2000;
+    // Mean distance, in placement order, between a net's driver and its sinks.
+    double locality = 16.0;
+    // Net sizes follow P(s) proportional to s^-sizeExponent on [2, maxRank], so most nets have 2-4 pins.
+    double sizeExponent = 2.8;
+    uint32_t maxRank = 64;
+    uint32_t maxWeight = 100;
+    uint64_t seed = 0;
+    unsigned threads = 1;
+};
+
+// Netlist-like locality: cells sit on a line in placement order, each net has a
+// uniform driver and sinks at geometric distances on either side of it.
+inline Hypergraph netlistHypergraph(const NetlistOptions &options) {
+    const uint32_t n = options.n;
+    if (n < 2 || options.maxWeight == 0 || options.locality < 1.0)
+        throw std::runtime_error("netlistHypergraph needs n >= 2, maxWeight >= 1 and locality >= 1");
+    const AliasTable sizes = powerLawSizes(2, std::clamp(options.maxRank, 2u, n), options.sizeExponent);
+
+    return generateEdges(n, options.m, options.seed, options.threads, [&](std::mt19937_64 &rng, std::vector<uint32_t> &pins) {
+        const size_t first = pins.size();
+        const uint32_t size = 2 + sizes.sample(rng);
+        const uint32_t driver = std::uniform_int_distribution<uint32_t>(0, n - 1)(rng);
+        std::geometric_distribution<uint32_t> distance(1.0 / options.locality);
+        PinSet &seen = threadPinSet(n);
+        seen.insert(driver);
+        pins.push_back(driver);
+        for (uint32_t attempts = 0; pins.size() - first < size;) {
+            uint32_t v;
+            if (++attempts <= 8 * size) {
+                const int64_t offset = 1 + static_cast<int64_t>(distance(rng));
+                const int64_t signedOffset = rng() & 1 ? offset : -offset;
+                int64_t target = static_cast<int64_t>(driver) + signedOffset;
+                if (target < 0 || target >= n)
+                    target = static_cast<int64_t>(driver) - signedOffset;
+                if (target < 0 || target >= n)
+                    continue;
+                v = static_cast<uint32_t>(target);
+            } else {
+                v = std::uniform_int_distribution<uint32_t>(0, n - 1)(rng);
+            }
+            if (seen.insert(v))
+                pins.push_back(v);
+        }
+        seen.clear({pins.data() + first, size});
+        return std::uniform_int_distribution<uint32_t>(1, options.maxWeight)(rng);
+    });
+}
+
+struct PlantOptions {
+    // Edges spanning both sides; their total weight is the planted cut.
+    uint32_t crossingEdges = 16;
+    uint32_t rank = 4;
+    uint32_t maxWeight = 100;
+    uint64_t seed = 0;
+};
+
+struct PlantedHypergraph {
+    Hypergraph H;
+    uint64_t minCut;
+    // True on the vertices that came from `left`.
+    std::vector<bool> side;
+};
+
+// Places left on vertices [0, left.n) and right after it, adds crossingEdges
+// edges of total weight W that span both sides, and strengthens each side with a
+// cyclic chain of windows: the side's vertices in random order, and for every
+// position an edge over the next min(rank, size) of them, of weight W / 2 + 1.
+// Splitting a side cuts at least two windows, more than W, and every cut other
+// than (left, right) splits a side, so the minimum cut is exactly W.
+inline PlantedHypergraph plantCut(const Hypergraph &left, const Hypergraph &right, const PlantOptions &options) {
+    if (left.n == 0 || right.n == 0 || options.maxWeight == 0)
+        throw std::runtime_error("plantCut needs two non-empty sides and maxWeight >= 1");
+    std::mt19937_64 rng(splitmix64(options.seed));
+    std::uniform_int_distribution<uint32_t> weight(1, options.maxWeight);
+    const uint32_t n = left.n + right.n;
+
+    PlantedHypergraph planted{Hypergraph{}, 0, std::vector<bool>(n, false)};
+    Hypergraph &H = planted.H;
+    H.n = n;
+    H.reserve(left.numEdges() + right.numEdges() + options.crossingEdges + n,
+              left.numPins() + right.numPins() + static_cast<size_t>(options.rank + 2) * (options.crossingEdges + n));
+    std::fill(planted.side.begin(), planted.side.begin() + left.n, true);
+
+    std::vector<uint32_t> edge;
+    for (size_t e = 0; e < left.numEdges(); ++e)
+        H.addEdge(left.edgePins(e), left.weight(e));
+    for (size_t e = 0; e < right.numEdges(); ++e) {
+        edge.clear();
+        for (uint32_t v : right.edgePins(e))
+            edge.push_back(left.n + v);
+        H.addEdge(edge, right.weight(e));
+    }
+
+    const uint32_t rank = std::clamp(options.rank, 2u, n);
+    for (uint32_t i = 0; i < options.crossingEdges; ++i) {
+        const uint32_t fromLeft = std::uniform_int_distribution<uint32_t>(1, std::min(rank - 1, left.n))(rng);
+        const uint32_t fromRight = std::min(rank - fromLeft, right.n);
+        edge.clear();
+        sampleSubset(left.n, fromLeft, rng, edge);
+        const size_t split = edge.size();
+        sampleSubset(right.n, fromRight, rng, edge);
+        for (size_t j = split; j < edge.size(); ++j)
+            edge[j] += left.n;
+        const uint32_t w = weight(rng);
+        planted.minCut += w;
+        H.addEdge(edge, w);
+    }
+
+    const uint64_t windowWeight = planted.minCut / 2 + 1;
+    if (windowWeight > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("plantCut: planted cut too heavy for 32-bit edge weights");
+    for (auto [base, size] : {std::pair{0u, left.n}, std::pair{left.n, right.n}}) {
+        if (size < 2)
+            continue;
+        std::vector<uint32_t> order(size);
+        std::iota(order.begin(), order.end(), base);
+        std::shuffle(order.begin(), order.end(), rng);
+        const uint32_t width = std::min(rank, size);
+        for (uint32_t i = 0; i < size; ++i) {
+            edge.clear();
+            for (uint32_t j = 0; j < width; ++j)
+                edge.push_back(order[(i + j) % size]);
+            H.addEdge(edge, static_cast<uint32_t>(windowWeight));
+        }
+    }
+    return planted;
+}
@@ -1,10 +1,12 @@
-
+#include "flat_array.h"
+#include "mapped_file.h"
 #include <algorithm>
-#include <fstream>
+#include <cstdint>
 #include <iostream>
 #include <random>
-#include <sstream>
-#include <unordered_set>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #ifndef HYPERGRAPH
@@ -18,80 +20,256 @@ struct Hyperedge {
         : vertices(std::move(v)), weight(w) {}
 };
 
+struct HgrOptions {
+    // Standard hMETIS files are 1-based; the converted circuit files are 0-based.
+    // Auto treats a file as 1-based only if it uses vertex n and not vertex 0,
+    // rejects one that uses both, and treats any other file as 0-based.
+    enum class IndexBase { Auto, Zero, One };
+    IndexBase indexBase = IndexBase::Auto;
+    // Replaces the file's edge weights with uniform [1, 100] draws from mt19937(syntheticSeed).
+    bool syntheticWeights = false;
+    uint32_t syntheticSeed = 0;
+};
+
+// Line-oriented integer scanner over an in-memory hMETIS file.
+class HgrParser {
+    const char *p;
+    const char *end;
+
+  public:
+    explicit HgrParser(std::string_view text) : p(text.data()), end(text.data() + text.size()) {}
+
+    // Moves to the start of the next non-blank, non-comment line.
+    bool nextRecord() noexcept {
+        while (p < end) {
+            const char *q = p;
+            while (q < end && (*q == ' ' || *q == '\t' || *q == '\r'))
+                ++q;
+            if (q < end && *q != '\n' && *q != '%') {
+                p = q;
+                return true;
+            }
+            while (q < end && *q != '\n')
+                ++q;
+            p = q < end ? q + 1 : end;
+        }
+        return false;
+    }
+
+    // Reads the next integer on the current line; at the end of the line, consumes it and returns false.
+    bool readInt(uint64_t &value) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+        if (p == end)
+            return false;
+        if (*p == '\n') {
+            ++p;
+            return false;
+        }
+        if (static_cast<unsigned>(*p - '0') > 9)
+            throw std::runtime_error(std::string("unexpected character '") + *p + "' in hMETIS file");
+        uint64_t x = 0;
+        do {
+            const unsigned digit = static_cast<unsigned>(*p++ - '0');
+            if (x > (UINT64_MAX - digit) / 10)
+                throw std::runtime_error("integer out of range in hMETIS file");
+            x = x * 10 + digit;
+        } while (p < end && static_cast<unsigned>(*p - '0') <= 9);
+        value = x;
+        return true;
+    }
+};
+
+// Non-owning view of one edge of a Hypergraph, shaped like Hyperedge so that
+// `H.edges()[i].vertices` / `.weight` keep working on the flat layout.
+struct HyperedgeView {
+    std::span<const uint32_t> vertices;
+    uint32_t weight{};
+
+    operator Hyperedge() const { return {std::vector<uint32_t>(vertices.begin(), vertices.end()), weight}; }
+};
+
+// Edges are stored CSR-style: the pins of edge e are pins[offsets[e], offsets[e + 1]).
+// The arrays may borrow a mapped cache file (see hypergraph_cache.h); copies share it.
+// The vertex -> incident edge index is optional and only valid after buildIncidence().
 struct Hypergraph {
     uint32_t n{};
-    std::vector<Hyperedge> edges;
+    FlatArray<uint32_t> pins;
+    FlatArray<uint64_t> offsets{0};
+    FlatArray<uint32_t> weights;
+    FlatArray<uint32_t> vertexWeights;
+    FlatArray<uint64_t> incidenceOffsets;
+    FlatArray<uint32_t> incidentEdges;
+
+    class EdgeRange {
+        const Hypergraph *H;
+
+      public:
+        class iterator {
+            const Hypergraph *H;
+            size_t e;
+
+          public:
+            iterator(const Hypergraph *H, size_t e) : H(H), e(e) {}
+            HyperedgeView operator*() const noexcept { return H->edge(e); }
+            iterator &operator++() noexcept {
+                ++e;
+                return *this;
+            }
+            bool operator==(const iterator &other) const noexcept { return e == other.e; }
+        };
+
+        explicit EdgeRange(const Hypergraph *H) : H(H) {}
+        size_t size() const noexcept { return H->numEdges(); }
+        bool empty() const noexcept { return H->numEdges() == 0; }
+        HyperedgeView operator[](size_t e) const noexcept { return H->edge(e); }
+        iterator begin() const noexcept { return {H, 0}; }
+        iterator end() const noexcept { return {H, H->numEdges()}; }
+    };
 
     explicit Hypergraph() = default;
 
-    explicit Hypergraph(const std::string &fileName) {
-        std::ifstream fin(fileName);
-        int numHyperedges, numVertices;
-        fin >> numHyperedges >> numVertices;
-        edges = std::vector<Hyperedge>(numHyperedges);
-        n = numVertices;
-        std::string line;
+    explicit Hypergraph(const std::string &fileName, const HgrOptions &options = {}) {
+        MappedFile file(fileName);
+        HgrParser in(file.view());
 
-        std::mt19937 gen(0);
+        if (!in.nextRecord())
+            throw std::runtime_error(fileName + ": missing hMETIS header");
+        uint64_t numHyperedges, numVertices, fmt = 0;
+        if (!in.readInt(numHyperedges) || !in.readInt(numVertices))
+            throw std::runtime_error(fileName + ": malformed hMETIS header");
+        in.readInt(fmt);
+        if (fmt != 0 && fmt != 1 && fmt != 10 && fmt != 11)
+            throw std::runtime_error(fileName + ": unsupported hMETIS fmt " + std::to_string(fmt));
+        const bool hasEdgeWeights = fmt % 10 == 1;
+        const bool hasVertexWeights = fmt / 10 == 1;
+
+        if (numVertices > UINT32_MAX)
+            throw std::runtime_error(fileName + ": vertex count out of range");
+        n = static_cast<uint32_t>(numVertices);
+        // The header fixes the edge count; pins grow as they are read, starting from
+        // one per edge. A record takes at least two bytes, which caps a bogus header.
+        const uint64_t edgeHint = std::min<uint64_t>(numHyperedges, file.size() / 2 + 1);
+        std::vector<uint32_t> pinBuffer;
+        std::vector<uint64_t> offsetBuffer;
+        std::vector<uint32_t> weightBuffer;
+        pinBuffer.reserve(edgeHint);
+        offsetBuffer.reserve(edgeHint + 1);
+        weightBuffer.reserve(edgeHint);
+        offsetBuffer.push_back(0);
+
+        std::mt19937 gen(options.syntheticSeed);
         std::uniform_int_distribution<> distrib(1, 100);
 
-        std::getline(fin, line);
+        uint64_t minPin = UINT64_MAX, maxPin = 0;
+        for (uint64_t i = 0; i < numHyperedges; i++) {
+            if (!in.nextRecord())
+                throw std::runtime_error(fileName + ": expected " + std::to_string(numHyperedges) + " hyperedges, found " + std::to_string(i));
+            uint64_t w = 1;
+            if (hasEdgeWeights && !in.readInt(w))
+                throw std::runtime_error(fileName + ": hyperedge " + std::to_string(i) + " has no weight");
+            if (w > UINT32_MAX)
+                throw std::runtime_error(fileName + ": hyperedge " + std::to_string(i) + " weight out of range");
+            uint64_t v;
+            while (in.readInt(v)) {
+                minPin = std::min(minPin, v);
+                maxPin = std::max(maxPin, v);
+                pinBuffer.push_back(static_cast<uint32_t>(v));
+            }
+            offsetBuffer.push_back(pinBuffer.size());
+            weightBuffer.push_back(options.syntheticWeights ? static_cast<uint32_t>(distrib(gen)) : static_cast<uint32_t>(w));
+        }
+
+        bool oneBased = options.indexBase == HgrOptions::IndexBase::One;
+        if (options.indexBase == HgrOptions::IndexBase::Auto && !pinBuffer.empty()) {
+            if (maxPin == n && minPin == 0)
+                throw std::runtime_error(fileName + ": pins span 0 to " + std::to_string(n) + ", which fits neither 0- nor 1-based indexing");
+            oneBased = maxPin == n;
+        }
+        if (!pinBuffer.empty() && (oneBased ? minPin == 0 || maxPin > n : maxPin >= n))
+            throw std::runtime_error(fileName + ": pin index out of range");
+        if (oneBased)
+            for (auto &v : pinBuffer)
+                --v;
 
-        for (int i = 0; i < numHyperedges; i++) {
-            std::getline(fin, line);
-            std::istringstream iss(line);
-            std::vector<uint32_t> edgeVertices;
+        pins = FlatArray<uint32_t>(std::move(pinBuffer));
+        offsets = FlatArray<uint64_t>(std::move(offsetBuffer));
+        weights = FlatArray<uint32_t>(std::move(weightBuffer));
 
-            uint32_t vertexInd;
-            while (iss >> vertexInd) {
-                edgeVertices.push_back(vertexInd);
+        if (hasVertexWeights) {
+            vertexWeights.resize(n);
+            uint64_t w;
+            for (uint32_t v = 0; v < n; ++v) {
+                if (!in.nextRecord() || !in.readInt(w))
+                    throw std::runtime_error(fileName + ": expected " + std::to_string(n) + " vertex weights");
+                if (w > UINT32_MAX)
+                    throw std::runtime_error(fileName + ": vertex " + std::to_string(v) + " weight out of range");
+                vertexWeights[v] = static_cast<uint32_t>(w);
             }
-            uint32_t randomWeight = distrib(gen);
-            edges[i].weight = randomWeight;
-            edges[i].vertices = edgeVertices;
         }
-    };
-};
+    }
 
-Hypergraph
-kUniformHypergraph(std::uniform_int_distribution<uint32_t> weight_dist, int n,
-                   int m, int k, int seed) {
-    std::cout << "generated with seed " << seed << std::endl;
-    Hypergraph hypergraph;
-    hypergraph.n = n;
-    std::mt19937 rng(seed);
-    std::vector<uint32_t> vertices(n);
-    for (uint32_t i = 0; i < n; ++i)
-        vertices[i] = i;
-
-    auto generate_k_subset = [&](std::mt19937 &rng) {
-        std::vector<uint32_t> subset(vertices.begin(), vertices.end());
-        std::shuffle(subset.begin(), subset.end(), rng);
-        subset.resize(k);
-        std::sort(subset.begin(), subset.end());
-        return subset;
-    };
+    size_t numEdges() const noexcept { return weights.size(); }
+    size_t numPins() const noexcept { return pins.size(); }
+
+    std::span<const uint32_t> edgePins(size_t e) const noexcept { return {pins.data() + offsets[e], pins.data() + offsets[e + 1]}; }
+    uint32_t edgeSize(size_t e) const noexcept { return static_cast<uint32_t>(offsets[e + 1] - offsets[e]); }
+    uint32_t weight(size_t e) const noexcept { return weights[e]; }
 
-    std::unordered_set<std::string> edgeSet;
-    int generated = 0;
+    HyperedgeView edge(size_t e) const noexcept { return {edgePins(e), weights[e]}; }
+    EdgeRange edges() const noexcept { return EdgeRange(this); }
 
-    while (generated < m) {
-        auto edgeVertices = generate_k_subset(rng);
+    void reserve(size_t m, size_t p) {
+        offsets.reserve(m + 1);
+        weights.reserve(m);
+        pins.reserve(p);
+    }
 
-        std::string key;
-        for (auto v : edgeVertices)
-            key += std::to_string(v) + ",";
+    void addEdge(std::span<const uint32_t> vertices, uint32_t w) {
+        pins.append(vertices.begin(), vertices.end());
+        offsets.push_back(pins.size());
+        weights.push_back(w);
+    }
 
-        if (edgeSet.insert(key).second) {
-            Hyperedge edge;
-            edge.vertices = edgeVertices;
-            edge.weight = weight_dist(rng);
-            hypergraph.edges.push_back(edge);
-            generated++;
-        }
+    void addEdge(const Hyperedge &e) { addEdge(e.vertices, e.weight); }
+
+    void clearEdges() noexcept {
+        pins.clear();
+        offsets.assign(1, 0);
+        weights.clear();
+        incidenceOffsets.clear();
+        incidentEdges.clear();
+    }
+
+    // Keeps only the first m edges, for callers that compact the CSR arrays in place.
+    void truncate(size_t m, size_t p) {
+        offsets.resize(m + 1);
+        weights.resize(m);
+        pins.resize(p);
+        incidenceOffsets.clear();
+        incidentEdges.clear();
     }
 
-    return hypergraph;
-}
+    void buildIncidence() {
+        incidenceOffsets.assign(n + 1, 0);
+        uint64_t *start = incidenceOffsets.mutableData();
+        for (uint32_t v : pins)
+            ++start[v + 1];
+        for (uint32_t v = 0; v < n; ++v)
+            start[v + 1] += start[v];
+        incidentEdges.resize(pins.size());
+        uint32_t *incident = incidentEdges.mutableData();
+        std::vector<uint64_t> cursor(start, start + n);
+        for (size_t e = 0; e < numEdges(); ++e)
+            for (uint32_t v : edgePins(e))
+                incident[cursor[v]++] = static_cast<uint32_t>(e);
+    }
+
+    bool hasIncidence() const noexcept { return incidenceOffsets.size() == n + 1; }
+
+    std::span<const uint32_t> incidentTo(uint32_t v) const noexcept {
+        return {incidentEdges.data() + incidenceOffsets[v], incidentEdges.data() + incidenceOffsets[v + 1]};
+    }
+};
 
 #endif // HYPERGRAPH_MIN_CUT_HYPERGRAPH_H
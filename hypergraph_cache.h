@@ -0,0 +1,168 @@
+#pragma once
+
+#include "hypergraph.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Binary hypergraph cache. A 64-byte header is followed by the CSR arrays exactly
+// as Hypergraph stores them, each padded to 8 bytes, so a mapped file can back
+// the graph directly:
+//   offsets[m + 1] (u64) | pins[p] (u32) | weights[m] (u32) | vertexWeights[n] (u32, optional)
+// Integers are native-endian; the magic doubles as an endianness check.
+struct HypergraphCacheHeader {
+    static constexpr char MAGIC[8] = {'H', 'M', 'C', 'G', 'R', 'A', 'P', 'H'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t VERTEX_WEIGHTS = 1;
+    static constexpr uint32_t SYNTHETIC_WEIGHTS = 2;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t n;
+    uint64_t m;
+    uint64_t pins;
+    uint32_t syntheticSeed;
+    uint32_t indexBase;
+    uint64_t checksum;
+    uint64_t reserved;
+};
+static_assert(sizeof(HypergraphCacheHeader) == 64);
+
+inline constexpr size_t cachePadded(size_t bytes) noexcept { return (bytes + 7) & ~size_t{7}; }
+
+inline uint64_t cacheChecksum(const char *data, size_t size) noexcept {
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ size;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+inline std::string cachePathFor(const std::string &hgrPath) { return hgrPath + ".hgrb"; }
+
+inline void writeHypergraphCache(const Hypergraph &H, const std::string &path, const HgrOptions &options = {}) {
+    const size_t m = H.numEdges();
+    const bool hasVertexWeights = !H.vertexWeights.empty();
+    std::string payload(cachePadded((m + 1) * 8) + cachePadded(H.numPins() * 4) + cachePadded(m * 4) +
+                            (hasVertexWeights ? cachePadded(size_t{H.n} * 4) : 0),
+                        '\0');
+    char *out = payload.data();
+    auto put = [&](const auto &array) {
+        const size_t bytes = array.size() * sizeof(array[0]);
+        if (bytes)
+            std::memcpy(out, array.data(), bytes);
+        out += cachePadded(bytes);
+    };
+    put(H.offsets);
+    put(H.pins);
+    put(H.weights);
+    if (hasVertexWeights)
+        put(H.vertexWeights);
+
+    HypergraphCacheHeader header{};
+    std::memcpy(header.magic, HypergraphCacheHeader::MAGIC, 8);
+    header.version = HypergraphCacheHeader::VERSION;
+    header.flags = (hasVertexWeights ? HypergraphCacheHeader::VERTEX_WEIGHTS : 0) |
+                   (options.syntheticWeights ? HypergraphCacheHeader::SYNTHETIC_WEIGHTS : 0);
+    header.n = H.n;
+    header.m = m;
+    header.pins = H.numPins();
+    header.syntheticSeed = options.syntheticWeights ? options.syntheticSeed : 0;
+    header.indexBase = static_cast<uint32_t>(options.indexBase);
+    header.checksum = cacheChecksum(payload.data(), payload.size());
+
+    // Written under a temporary name so concurrent readers never map a partial file.
+    // The temporary is removed again if writing or renaming fails.
+    const std::string tmp = path + ".tmp" + std::to_string(::getpid());
+    try {
+        {
+            std::ofstream fout(tmp, std::ios::binary | std::ios::trunc);
+            fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            fout.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            if (!fout)
+                throw std::runtime_error("cannot write " + tmp);
+        }
+        std::filesystem::rename(tmp, path);
+    } catch (...) {
+        std::error_code ignored;
+        std::filesystem::remove(tmp, ignored);
+        throw;
+    }
+}
+
+inline void convertHgrToCache(const std::string &hgrPath, const std::string &cachePath, const HgrOptions &options = {}) {
+    writeHypergraphCache(Hypergraph(hgrPath, options), cachePath, options);
+}
+
+// Maps a cache file and returns a graph whose arrays point into the mapping.
+inline Hypergraph loadHypergraphCache(const std::string &path, bool verifyChecksum = true,
+                                      HypergraphCacheHeader *headerOut = nullptr) {
+    auto file = std::make_shared<const MappedFile>(path, MADV_WILLNEED);
+    HypergraphCacheHeader header;
+    if (file->size() < sizeof(header))
+        throw std::runtime_error(path + ": truncated hypergraph cache");
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, HypergraphCacheHeader::MAGIC, 8) != 0)
+        throw std::runtime_error(path + ": not a hypergraph cache");
+    if (header.version != HypergraphCacheHeader::VERSION)
+        throw std::runtime_error(path + ": unsupported cache version " + std::to_string(header.version));
+
+    const bool hasVertexWeights = header.flags & HypergraphCacheHeader::VERTEX_WEIGHTS;
+    const size_t offsetBytes = cachePadded((header.m + 1) * 8);
+    const size_t pinBytes = cachePadded(header.pins * 4);
+    const size_t weightBytes = cachePadded(header.m * 4);
+    const size_t payloadBytes = offsetBytes + pinBytes + weightBytes + (hasVertexWeights ? cachePadded(header.n * 4) : 0);
+    if (file->size() != sizeof(header) + payloadBytes)
+        throw std::runtime_error(path + ": cache size does not match its header");
+    const char *payload = file->data() + sizeof(header);
+    if (verifyChecksum && cacheChecksum(payload, payloadBytes) != header.checksum)
+        throw std::runtime_error(path + ": cache checksum mismatch");
+
+    Hypergraph H;
+    H.n = static_cast<uint32_t>(header.n);
+    H.offsets = FlatArray<uint64_t>::borrow(reinterpret_cast<const uint64_t *>(payload), header.m + 1, file);
+    H.pins = FlatArray<uint32_t>::borrow(reinterpret_cast<const uint32_t *>(payload + offsetBytes), header.pins, file);
+    H.weights = FlatArray<uint32_t>::borrow(reinterpret_cast<const uint32_t *>(payload + offsetBytes + pinBytes), header.m, file);
+    if (hasVertexWeights)
+        H.vertexWeights = FlatArray<uint32_t>::borrow(reinterpret_cast<const uint32_t *>(payload + offsetBytes + pinBytes + weightBytes), header.n, file);
+    if (H.offsets[0] != 0 || H.offsets.back() != header.pins)
+        throw std::runtime_error(path + ": corrupt cache offsets");
+    if (headerOut)
+        *headerOut = header;
+    return H;
+}
+
+// Loads an .hgr file through its cache, (re)building the cache when it is missing,
+// older than the source, or was written with different load options.
+inline Hypergraph loadHypergraph(const std::string &hgrPath, const HgrOptions &options = {}) {
+    namespace fs = std::filesystem;
+    const std::string cachePath = cachePathFor(hgrPath);
+    std::error_code ec;
+    auto cacheTime = fs::last_write_time(cachePath, ec);
+    if (!ec && cacheTime >= fs::last_write_time(hgrPath)) {
+        try {
+            HypergraphCacheHeader header;
+            Hypergraph H = loadHypergraphCache(cachePath, true, &header);
+            const bool synthetic = header.flags & HypergraphCacheHeader::SYNTHETIC_WEIGHTS;
+            if (synthetic == options.syntheticWeights && (!synthetic || header.syntheticSeed == options.syntheticSeed) &&
+                header.indexBase == static_cast<uint32_t>(options.indexBase))
+                return H;
+        } catch (const std::runtime_error &) {
+        }
+    }
+
+    Hypergraph H(hgrPath, options);
+    try {
+        writeHypergraphCache(H, cachePath, options);
+    } catch (const std::exception &) {
+        // A read-only input directory only costs us the cache.
+    }
+    return H;
+}
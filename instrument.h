@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(HMC_INSTRUMENT) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HMC_PERF_EVENTS 1
+#endif
+
+// Per-phase timers, a recursion depth histogram, allocated bytes and optional
+// hardware counters for one solver call. Built with HMC_INSTRUMENT the probe
+// macros below record into a per-thread Profile; without it they expand to
+// nothing and ProfileSession::stop() returns an empty, disabled Profile.
+//
+//   ProfileSession session(true);
+//   deterministicMinCut(H);
+//   session.stop().writeJson(std::cout);
+//
+// Only one session may be active at a time, and stop() must run after every
+// thread that worked on the solve is done with it.
+
+enum class Probe : uint8_t {
+    // Randomized solvers: drawing an edge, contracting it (ContractionState or the
+    // bitset state) and removing collapsed or spanning edges.
+    ChooseEdge,
+    Contract,
+    KSpanning,
+    // deterministicMinCut: building the working arrays, refilling the queue and
+    // merging s and t around each phase, and the MA ordering itself.
+    Setup,
+    PhaseRebuild,
+    MaOrdering,
+    Count,
+};
+
+inline constexpr std::array<const char *, static_cast<size_t>(Probe::Count)> PROBE_NAMES{
+    "choose_edge", "contract", "k_spanning", "setup", "phase_rebuild", "ma_ordering",
+};
+
+struct Profile {
+    struct Timer {
+        uint64_t calls = 0;
+        uint64_t nanos = 0;
+    };
+
+    bool enabled = false;
+    std::array<Timer, static_cast<size_t>(Probe::Count)> timers{};
+    // depthHistogram[i] counts recursion nodes with depth + 1 in [2^i, 2^(i+1)).
+    std::array<uint64_t, 32> depthHistogram{};
+    // Bytes drawn from the randomized solver's arenas and held by the
+    // deterministic solver's working arrays.
+    uint64_t bytesAllocated = 0;
+    // Set when perf_event_open was requested and succeeded.
+    bool hardwareCounters = false;
+    uint64_t cycles = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+
+    void merge(const Profile &other) {
+        enabled |= other.enabled;
+        for (size_t i = 0; i < timers.size(); ++i) {
+            timers[i].calls += other.timers[i].calls;
+            timers[i].nanos += other.timers[i].nanos;
+        }
+        for (size_t i = 0; i < depthHistogram.size(); ++i)
+            depthHistogram[i] += other.depthHistogram[i];
+        bytesAllocated += other.bytesAllocated;
+        hardwareCounters |= other.hardwareCounters;
+        cycles += other.cycles;
+        cacheMisses += other.cacheMisses;
+        branchMisses += other.branchMisses;
+    }
+
+    void writeJson(std::ostream &out) const {
+        out << "{\"enabled\": " << (enabled ? "true" : "false") << ", \"timers\": {";
+        for (size_t i = 0; i < timers.size(); ++i)
+            out << (i ? ", " : "") << "\"" << PROBE_NAMES[i] << "\": {\"calls\": " << timers[i].calls << ", \"ms\": " << timers[i].nanos / 1e6 << "}";
+        out << "}, \"bytes_allocated\": " << bytesAllocated << ", \"depth_histogram\": [";
+        bool first = true;
+        for (size_t i = 0; i < depthHistogram.size(); ++i) {
+            if (!depthHistogram[i])
+                continue;
+            out << (first ? "" : ", ") << "{\"min_depth\": " << (uint64_t{1} << i) - 1 << ", \"count\": " << depthHistogram[i] << "}";
+            first = false;
+        }
+        out << "], \"hardware\": ";
+        if (hardwareCounters)
+            out << "{\"cycles\": " << cycles << ", \"cache_misses\": " << cacheMisses << ", \"branch_misses\": " << branchMisses << "}";
+        else
+            out << "null";
+        out << "}";
+    }
+};
+
+#ifdef HMC_INSTRUMENT
+namespace instrument {
+
+// Every thread that records owns one Profile. Threads that exit fold theirs into
+// `retired`, so pool workers that outlive their solve are still counted.
+class Registry {
+    std::mutex mutex;
+    std::vector<Profile *> live;
+    Profile retired;
+
+  public:
+    static Registry &get() {
+        static Registry registry;
+        return registry;
+    }
+
+    void add(Profile *profile) {
+        std::lock_guard lock(mutex);
+        live.push_back(profile);
+    }
+
+    void remove(Profile *profile) {
+        std::lock_guard lock(mutex);
+        retired.merge(*profile);
+        std::erase(live, profile);
+    }
+
+    void reset() {
+        std::lock_guard lock(mutex);
+        retired = Profile{};
+        for (Profile *profile : live)
+            *profile = Profile{};
+    }
+
+    Profile collect() {
+        std::lock_guard lock(mutex);
+        Profile total = retired;
+        for (const Profile *profile : live)
+            total.merge(*profile);
+        total.enabled = true;
+        return total;
+    }
+};
+
+struct ThreadProfile {
+    Profile data;
+    ThreadProfile() { Registry::get().add(&data); }
+    ~ThreadProfile() { Registry::get().remove(&data); }
+};
+
+inline Profile &local() {
+    thread_local ThreadProfile profile;
+    return profile.data;
+}
+
+class ScopedTimer {
+    Probe probe;
+    std::chrono::steady_clock::time_point start;
+    bool running = true;
+
+  public:
+    explicit ScopedTimer(Probe probe) : probe(probe), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+    ~ScopedTimer() { stop(); }
+
+    void stop() {
+        if (!running)
+            return;
+        running = false;
+        auto &timer = local().timers[static_cast<size_t>(probe)];
+        ++timer.calls;
+        timer.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+inline void recordDepth(uint64_t depth) {
+    ++local().depthHistogram[std::min<size_t>(std::bit_width(depth + 1) - 1, 31)];
+}
+
+inline void addBytes(uint64_t bytes) { local().bytesAllocated += bytes; }
+
+// Cycles, cache misses and branch misses of the calling thread and of every
+// thread it starts afterwards (inherit), user space only.
+class PerfCounters {
+    std::array<int, 3> fds{-1, -1, -1};
+
+  public:
+    PerfCounters() {
+#ifdef HMC_PERF_EVENTS
+        constexpr std::array<uint64_t, 3> events{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t i = 0; i < events.size(); ++i) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = events[i];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        if (!valid())
+            return;
+        for (int fd : fds) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+#ifdef HMC_PERF_EVENTS
+        for (int fd : fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    bool valid() const noexcept { return fds[0] >= 0 && fds[1] >= 0 && fds[2] >= 0; }
+
+    // Stops counting and stores the totals in profile; false if unavailable.
+    bool read(Profile &profile) {
+#ifdef HMC_PERF_EVENTS
+        if (!valid())
+            return false;
+        std::array<uint64_t, 3> values{};
+        for (size_t i = 0; i < fds.size(); ++i) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(fds[i], &values[i], sizeof(values[i])) != sizeof(values[i]))
+                return false;
+        }
+        profile.cycles = values[0];
+        profile.cacheMisses = values[1];
+        profile.branchMisses = values[2];
+        profile.hardwareCounters = true;
+        return true;
+#else
+        (void)profile;
+        return false;
+#endif
+    }
+};
+
+} // namespace instrument
+
+#define HMC_PROBE_CONCAT_(a, b) a##b
+#define HMC_PROBE_CONCAT(a, b) HMC_PROBE_CONCAT_(a, b)
+#define HMC_PROBE(probe) ::instrument::ScopedTimer HMC_PROBE_CONCAT(hmcProbe, __LINE__)(probe)
+#define HMC_PROBE_AS(name, probe) ::instrument::ScopedTimer name(probe)
+#define HMC_PROBE_STOP(name) name.stop()
+#define HMC_DEPTH(depth) ::instrument::recordDepth(depth)
+#define HMC_ADD_BYTES(bytes) ::instrument::addBytes(bytes)
+
+class ProfileSession {
+    std::unique_ptr<instrument::PerfCounters> counters;
+
+  public:
+    explicit ProfileSession(bool hardwareCounters = false) {
+        instrument::Registry::get().reset();
+        if (hardwareCounters)
+            counters = std::make_unique<instrument::PerfCounters>();
+    }
+
+    Profile stop() {
+        Profile profile = instrument::Registry::get().collect();
+        if (counters)
+            counters->read(profile);
+        counters.reset();
+        return profile;
+    }
+};
+#else
+#define HMC_PROBE(probe) ((void)0)
+#define HMC_PROBE_AS(name, probe) ((void)0)
+#define HMC_PROBE_STOP(name) ((void)0)
+#define HMC_DEPTH(depth) ((void)0)
+#define HMC_ADD_BYTES(bytes) ((void)0)
+
+class ProfileSession {
+  public:
+    explicit ProfileSession(bool = false) {}
+    Profile stop() { return {}; }
+};
+#endif
@@ -1,4 +1,6 @@
 #include "deterministic.h"
+#include "generators.h"
+#include "hypergraph_cache.h"
 #include "randomized.h"
 #include <cmath>
 #include <cstdint>
@@ -21,8 +23,9 @@ void experimentOne(std::vector<size_t> nValues, std::vector<size_t> mValues, siz
     int baseSeed = seedMult * 1000000;
     for (auto n : nValues) {
         for (auto m : mValues) {
-            Hypergraph constK = kUniformHypergraph(std::uniform_int_distribution<uint32_t>(1, 100), n, m, 10, t + baseSeed);
-            Hypergraph logK = kUniformHypergraph(std::uniform_int_distribution<uint32_t>(1, 100), n, m, (int)std::sqrt(n), t + baseSeed);
+            std::cout << "generated with seed " << t + baseSeed << std::endl;
+            Hypergraph constK = uniformHypergraph(UniformOptions{.n = static_cast<uint32_t>(n), .m = m, .rank = 10, .seed = static_cast<uint64_t>(t + baseSeed)});
+            Hypergraph logK = uniformHypergraph(UniformOptions{.n = static_cast<uint32_t>(n), .m = m, .rank = static_cast<uint32_t>(std::sqrt(n)), .seed = static_cast<uint64_t>(t + baseSeed)});
             detConst << n << " " << m << std::endl;
             detLog << n << " " << m << std::endl;
             randConst << n << " " << m << std::endl;
@@ -74,11 +77,13 @@ void experimentTwoRandomized() {
     std::ofstream outputFile("outputs/exp2Randomized.txt");
     outputFile << "file_name trial #contractions #weight edges-cut time" << std::endl;
     for (const auto &entry : std::filesystem::directory_iterator(path_to_circuit)) {
+        if (entry.path().extension() == ".hgrb")
+            continue;
+        std::string file_name = entry.path().filename();
+        std::string full_file_name = path_to_circuit + "/" + file_name;
+        Hypergraph H = loadHypergraph(full_file_name, HgrOptions{.syntheticWeights = true});
         for (int t = 0; t < 10; t++) {
-            std::string file_name = entry.path().filename();
-            std::string full_file_name = path_to_circuit + "/" + file_name;
             outputFile << file_name << " " << t << " ";
-            Hypergraph H{full_file_name};
             auto start = std::chrono::high_resolution_clock::now();
             auto result = randomizedMinKCut(H, 2, 2, 1, t + 1);
             auto end = std::chrono::high_resolution_clock::now();
@@ -89,12 +94,14 @@ void experimentTwoRandomized() {
     outputFile << std::endl;
     std::string path_to_hyperff = "./hyperff_hypergraphs";
     for (const auto &entry : std::filesystem::directory_iterator(path_to_hyperff)) {
+        if (entry.path().extension() == ".hgrb")
+            continue;
+        std::string file_name = entry.path().filename();
+        std::string full_file_name = path_to_hyperff + "/" + file_name;
+        Hypergraph H = loadHypergraph(full_file_name, HgrOptions{.syntheticWeights = true});
         for (int t = 0; t < 10; t++) {
-            std::string file_name = entry.path().filename();
             std::cout << "Running " << file_name << std::endl;
-            std::string full_file_name = path_to_hyperff + "/" + file_name;
             outputFile << file_name << " ";
-            Hypergraph H{full_file_name};
             auto start = std::chrono::high_resolution_clock::now();
             auto result = randomizedMinKCut(H, 2, 2, 1, t + 1);
             auto end = std::chrono::high_resolution_clock::now();
@@ -112,12 +119,14 @@ void experimentTwoDeterministic() {
     std::ofstream outputFile("outputs/exp2Deterministic.txt");
     outputFile << "file_name trial #weight time" << std::endl;
     for (const auto &entry : std::filesystem::directory_iterator(path_to_circuit)) {
+        if (entry.path().extension() == ".hgrb")
+            continue;
+        std::string file_name = entry.path().filename();
+        std::string full_file_name = path_to_circuit + "/" + file_name;
+        Hypergraph H = loadHypergraph(full_file_name, HgrOptions{.syntheticWeights = true});
         for (int t = 0; t < 10; t++) {
-            std::string file_name = entry.path().filename();
             std::cout << "Running " << file_name << std::endl;
-            std::string full_file_name = path_to_circuit + "/" + file_name;
             outputFile << file_name << " " << t << " ";
-            Hypergraph H{full_file_name};
             auto start = std::chrono::high_resolution_clock::now();
             auto result = deterministicMinCut(H);
             auto end = std::chrono::high_resolution_clock::now();
@@ -129,12 +138,14 @@ void experimentTwoDeterministic() {
     outputFile << std::endl;
     std::string path_to_hyperff = "./hyperff_hypergraphs";
     for (const auto &entry : std::filesystem::directory_iterator(path_to_hyperff)) {
+        if (entry.path().extension() == ".hgrb")
+            continue;
+        std::string file_name = entry.path().filename();
+        std::string full_file_name = path_to_hyperff + "/" + file_name;
+        Hypergraph H = loadHypergraph(full_file_name, HgrOptions{.syntheticWeights = true});
         for (int t = 0; t < 10; t++) {
-            std::string file_name = entry.path().filename();
             std::cout << "Running " << file_name << std::endl;
-            std::string full_file_name = path_to_hyperff + "/" + file_name;
             outputFile << file_name << " " << t << " ";
-            Hypergraph H{full_file_name};
             auto start = std::chrono::high_resolution_clock::now();
             auto result = deterministicMinCut(H);
             auto end = std::chrono::high_resolution_clock::now();
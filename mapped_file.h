@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only, private mapping of a whole file. Empty files map to an empty view.
+class MappedFile {
+    const char *ptr = nullptr;
+    size_t len = 0;
+
+  public:
+    explicit MappedFile(const std::string &path, int advice = MADV_SEQUENTIAL) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path + ": " + std::strerror(err));
+        }
+        len = static_cast<size_t>(st.st_size);
+        if (len > 0) {
+            void *p = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path + ": " + std::strerror(err));
+            }
+            ::madvise(p, len, advice);
+            ptr = static_cast<const char *>(p);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept : ptr(std::exchange(other.ptr, nullptr)), len(std::exchange(other.len, 0)) {}
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        std::swap(ptr, other.ptr);
+        std::swap(len, other.len);
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (ptr)
+            ::munmap(const_cast<char *>(ptr), len);
+    }
+
+    const char *data() const noexcept { return ptr; }
+    size_t size() const noexcept { return len; }
+    std::string_view view() const noexcept { return {ptr, len}; }
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Max-priority queues over vertex ids with increase-key, used for maximum
+// adjacency orderings. Both share one interface:
+//   reset(n, maxKey)  ids in [0, n), keys never exceed maxKey
+//   push(v, key), increase(v, delta), contains(v), empty(), popMax() -> {v, key}
+
+class AddressableMaxHeap {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> heap;
+    std::vector<uint32_t> pos;
+    std::vector<uint64_t> key;
+
+    void place(uint32_t i, uint32_t v) noexcept {
+        heap[i] = v;
+        pos[v] = i;
+    }
+
+    void siftUp(uint32_t i) noexcept {
+        const uint32_t v = heap[i];
+        while (i > 0) {
+            const uint32_t parent = (i - 1) / 2;
+            if (key[heap[parent]] >= key[v])
+                break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, v);
+    }
+
+    void siftDown(uint32_t i) noexcept {
+        const uint32_t v = heap[i];
+        const uint32_t size = static_cast<uint32_t>(heap.size());
+        while (true) {
+            uint32_t child = 2 * i + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && key[heap[child + 1]] > key[heap[child]])
+                ++child;
+            if (key[heap[child]] <= key[v])
+                break;
+            place(i, heap[child]);
+            i = child;
+        }
+        place(i, v);
+    }
+
+  public:
+    void reset(uint32_t n, uint64_t) {
+        heap.clear();
+        heap.reserve(n);
+        pos.assign(n, NONE);
+        key.assign(n, 0);
+    }
+
+    bool empty() const noexcept { return heap.empty(); }
+    bool contains(uint32_t v) const noexcept { return pos[v] != NONE; }
+
+    void push(uint32_t v, uint64_t k) {
+        key[v] = k;
+        heap.push_back(v);
+        siftUp(static_cast<uint32_t>(heap.size() - 1));
+    }
+
+    void increase(uint32_t v, uint64_t delta) noexcept {
+        key[v] += delta;
+        siftUp(pos[v]);
+    }
+
+    std::pair<uint32_t, uint64_t> popMax() noexcept {
+        const uint32_t top = heap[0];
+        const uint32_t last = heap.back();
+        heap.pop_back();
+        pos[top] = NONE;
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return {top, key[top]};
+    }
+};
+
+// Bucket queue for integer keys bounded by maxKey: O(1) increase-key, and popMax
+// scans down from the highest bucket, so a full ordering costs O(p + n + maxKey).
+class BucketQueue {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> head;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> prev;
+    std::vector<uint64_t> key;
+    std::vector<bool> queued;
+    uint64_t top = 0;
+    uint32_t count = 0;
+
+    void link(uint32_t v) noexcept {
+        const uint64_t k = key[v];
+        prev[v] = NONE;
+        next[v] = head[k];
+        if (head[k] != NONE)
+            prev[head[k]] = v;
+        head[k] = v;
+        if (k > top)
+            top = k;
+    }
+
+    void unlink(uint32_t v) noexcept {
+        if (prev[v] != NONE)
+            next[prev[v]] = next[v];
+        else
+            head[key[v]] = next[v];
+        if (next[v] != NONE)
+            prev[next[v]] = prev[v];
+    }
+
+  public:
+    // Buckets are only cleared by popping, so a queue that was drained is ready to reuse.
+    void reset(uint32_t n, uint64_t maxKey) {
+        head.assign(maxKey + 1, NONE);
+        next.assign(n, NONE);
+        prev.assign(n, NONE);
+        key.assign(n, 0);
+        queued.assign(n, false);
+        top = 0;
+        count = 0;
+    }
+
+    bool empty() const noexcept { return count == 0; }
+    bool contains(uint32_t v) const noexcept { return queued[v]; }
+
+    void push(uint32_t v, uint64_t k) noexcept {
+        key[v] = k;
+        queued[v] = true;
+        ++count;
+        link(v);
+    }
+
+    void increase(uint32_t v, uint64_t delta) noexcept {
+        unlink(v);
+        key[v] += delta;
+        link(v);
+    }
+
+    std::pair<uint32_t, uint64_t> popMax() noexcept {
+        while (head[top] == NONE)
+            --top;
+        const uint32_t v = head[top];
+        unlink(v);
+        queued[v] = false;
+        if (--count == 0)
+            top = 0;
+        return {v, key[v]};
+    }
+};
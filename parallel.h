@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// SplitMix64 finalizer. Parallel work derives its seeds from what it computes,
+// e.g. splitmix64(splitmix64(seed) + index), never from the thread that runs it.
+inline uint64_t splitmix64(uint64_t x) noexcept {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Fixed-size pool with one shared FIFO queue. The thread that waits on a
+// TaskGroup also runs queued tasks, so a pool of `threads` keeps that many
+// cores busy and nested groups cannot deadlock.
+class ThreadPool {
+    std::vector<std::jthread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+
+  public:
+    explicit ThreadPool(unsigned threads) {
+        for (unsigned i = 1; i < std::max(1u, threads); ++i) {
+            workers.emplace_back([this] {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock lock(mutex);
+                        cv.wait(lock, [this] { return stopping || !queue.empty(); });
+                        if (queue.empty())
+                            return;
+                        task = std::move(queue.front());
+                        queue.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    // Joins the workers before queue, mutex and cv are destroyed under them.
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        workers.clear();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const noexcept { return static_cast<unsigned>(workers.size()) + 1; }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(mutex);
+            queue.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+
+    // Runs one queued task on the calling thread; false if the queue was empty.
+    bool runPending() {
+        std::function<void()> task;
+        {
+            std::lock_guard lock(mutex);
+            if (queue.empty())
+                return false;
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    static unsigned resolveThreads(unsigned threads) noexcept {
+        return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+};
+
+class TaskGroup {
+    ThreadPool &pool;
+    std::atomic<size_t> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+  public:
+    explicit TaskGroup(ThreadPool &pool) : pool(pool) {}
+    ~TaskGroup() {
+        while (pending.load(std::memory_order_acquire))
+            if (!pool.runPending())
+                std::this_thread::yield();
+    }
+
+    template <class F>
+    void run(F &&f) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([this, f = std::forward<F>(f)]() mutable {
+            try {
+                f();
+            } catch (...) {
+                std::lock_guard lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void wait() {
+        while (pending.load(std::memory_order_acquire))
+            if (!pool.runPending())
+                std::this_thread::yield();
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+};
+
+// Calls f(i, slot) for every i in [0, count). Indices are handed out dynamically;
+// slot < pool.size() identifies the worker loop so callers can keep per-slot state.
+template <class F>
+void parallelFor(ThreadPool &pool, size_t count, F &&f) {
+    const unsigned slots = static_cast<unsigned>(std::min<size_t>(pool.size(), count));
+    std::atomic<size_t> next{0};
+    auto loop = [&](unsigned slot) {
+        try {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+                f(i, slot);
+        } catch (...) {
+            next.store(count, std::memory_order_relaxed);
+            throw;
+        }
+    };
+    // The group's destructor drains the other slots if slot 0 throws.
+    TaskGroup group(pool);
+    for (unsigned slot = 1; slot < slots; ++slot)
+        group.run([&loop, slot] { loop(slot); });
+    if (slots > 0)
+        loop(0);
+    group.wait();
+}
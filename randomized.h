@@ -1,11 +1,75 @@
+#include "arena.h"
+#include "bounds.h"
+#include "contraction.h"
+#include "control.h"
 #include "hypergraph.h"
+#include "parallel.h"
+#include "simd.h"
+#include "small_graph.h"
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <numbers>
+#include <optional>
+#include <type_traits>
 
 #ifndef RANDOMIZED
 #define RANDOMIZED
 
 
-class BatchTimeout : std::exception {};
+enum class RandomizedMode {
+    // Branching contractions for any k.
+    Branching,
+    // Karger-Stein recursive contraction; k = 2 only.
+    KargerStein,
+};
+
+// Why randomizedMinKCut stopped running batches.
+enum class StopReason {
+    // Ran the batches it planned: numBatchesFactor * log n, or numBatchesFactor
+    // for Karger-Stein.
+    Schedule,
+    // The success estimate reached 1 - failureProbability.
+    Confident,
+    // Kept extending while the best cut still moved, up to maxBatches.
+    BatchLimit,
+    // SolveControl expired.
+    Interrupted,
+    // The best cut reached RandomizedOptions::bounds->lower.
+    LowerBound,
+};
+
+struct RandomizedOptions {
+    uint64_t batchScale = 2;
+    uint64_t numBatchesFactor = 1;
+    // 0 draws the base seed from std::random_device.
+    uint64_t baseSeed = 0;
+    bool verbose = false;
+    // Worker threads for the iterations of a batch; 0 uses every hardware thread.
+    unsigned threads = 1;
+    // Branch points shallower than this, on graphs with at least parallelBranchMinEdges
+    // live edges, run their two subproblems as separate pool tasks.
+    uint32_t parallelBranchDepth = 8;
+    uint32_t parallelBranchMinEdges = 256;
+    RandomizedMode mode = RandomizedMode::Branching;
+    // Deadline, cancellation and improvement callback. When it expires the best
+    // cut found so far is returned with interrupted set, or isolatingCut if no
+    // iteration had completed one.
+    SolveControl control;
+    // Adaptive stopping, off at 0: batches stop once the estimated probability that a lighter cut
+    // was missed drops below this. Past the planned batches the run is extended
+    // while the best cut still improves, up to maxBatches (0 means twice the plan).
+    double failureProbability = 0.0;
+    uint64_t maxBatches = 0;
+    // Known bounds for k = 2, e.g. from cutBounds(); ignored for other k. The upper
+    // bound seeds the best cut, so edges heavier than it are contracted upfront and
+    // subtrees committing more are pruned from the first iteration. Batches stop
+    // once a cut reaches the lower bound.
+    const CutBounds *bounds = nullptr;
+};
 
 struct ContractionResult {
     uint64_t numCut;
@@ -13,6 +77,15 @@ struct ContractionResult {
     uint64_t totalContractions;
     uint64_t totalRuntime;
     bool success;
+    bool interrupted = false;
+    StopReason stopReason = StopReason::Schedule;
+    // Heuristic estimate of the probability that cutWeight is the minimum; see
+    // TrialStats. Without adaptive stopping, ties are pruned and this understates it.
+    double successEstimate = 0.0;
+    uint64_t batches = 0;
+    // Original edge ids of the cut; randomizedMinKCut also materializes their pins.
+    std::vector<uint32_t> cutEdges;
+    std::vector<Hyperedge> cut;
 };
 
 class DSU {
@@ -70,123 +143,417 @@ double redoProbability(uint32_t n, uint32_t edgeSize, uint32_t k) noexcept {
 
 Hypergraph contractEdge(const Hypergraph &H, size_t edgeIndex) {
     DSU dsu(H.n);
-    const auto &edge = H.edges[edgeIndex];
-    if (!edge.vertices.empty()) {
-        uint32_t first = edge.vertices[0];
-        for (size_t i = 1; i < edge.vertices.size(); ++i) {
-            dsu.unite(first, edge.vertices[i]);
+    const auto edge = H.edgePins(edgeIndex);
+    if (!edge.empty()) {
+        uint32_t first = edge[0];
+        for (size_t i = 1; i < edge.size(); ++i) {
+            dsu.unite(first, edge[i]);
         }
     }
-    std::vector<int32_t> vertexMap(H.n, -1);
-    int32_t nextId = 0;
+    constexpr uint32_t UNSET = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> vertexMap(H.n, UNSET);
+    uint32_t nextId = 0;
     for (uint32_t v = 0; v < H.n; ++v) {
         uint32_t root = dsu.find(v);
-        if (vertexMap[root] == -1) {
+        if (vertexMap[root] == UNSET) {
             vertexMap[root] = nextId++;
         }
         vertexMap[v] = vertexMap[root];
     }
 
     Hypergraph result;
-    result.n = static_cast<uint32_t>(nextId);
-    result.edges.reserve(H.edges.size());
+    result.n = nextId;
+    result.reserve(H.numEdges(), H.numPins());
 
+    PinDedup dedup(nextId);
     std::vector<uint32_t> newVertices;
     newVertices.reserve(H.n);
 
-    for (size_t i = 0; i < H.edges.size(); ++i) {
+    for (size_t i = 0; i < H.numEdges(); ++i) {
         if (i == edgeIndex)
             continue;
 
-        const auto &e = H.edges[i];
-        newVertices.clear();
+        newVertices.resize(H.edgeSize(i));
+        const size_t size = dedup.relabelUnique(H.edgePins(i), vertexMap.data(), newVertices.data());
 
-        for (uint32_t v : e.vertices) {
-            newVertices.push_back(static_cast<uint32_t>(vertexMap[v]));
-        }
-
-        std::sort(newVertices.begin(), newVertices.end());
-        newVertices.erase(std::unique(newVertices.begin(), newVertices.end()), newVertices.end());
-
-        if (newVertices.size() > 1) {
-            result.edges.emplace_back(newVertices, e.weight);
+        if (size > 1) {
+            result.addEdge(std::span<const uint32_t>(newVertices.data(), size), H.weight(i));
         }
     }
     return result;
 }
 
-uint32_t computeCutWeight(const std::vector<Hyperedge> &S) noexcept {
-    uint32_t total = 0;
+uint64_t computeCutWeight(const std::vector<Hyperedge> &S) noexcept {
+    uint64_t total = 0;
     for (const auto &e : S) {
         total += e.weight;
     }
     return total;
 }
 
-void getKSpanning(Hypergraph &H, uint32_t k, std::vector<Hyperedge> &S) {
-    uint32_t threshold = (H.n >= k - 1) ? (H.n - k + 2) : 1;
-    std::vector<Hyperedge> kept;
-    kept.reserve(H.edges.size());
-    for (auto &e : H.edges) {
-        if (e.vertices.size() >= threshold) {
-            S.push_back(std::move(e));
-        } else {
-            kept.push_back(std::move(e));
+std::vector<Hyperedge> materializeCut(const Hypergraph &H, std::span<const uint32_t> cutEdges) {
+    std::vector<Hyperedge> cut;
+    cut.reserve(cutEdges.size());
+    for (uint32_t e : cutEdges)
+        cut.push_back(H.edge(e));
+    return cut;
+}
+
+// Edge ids of the cut that isolates the k - 1 vertices of least weighted degree,
+// returned when a solve is interrupted before any iteration completes a cut.
+std::vector<uint32_t> isolatingCut(const Hypergraph &H, uint32_t k) {
+    constexpr uint32_t REST = std::numeric_limits<uint32_t>::max();
+    auto spans = [&](std::span<const uint32_t> pins, auto &&part) {
+        return std::any_of(pins.begin(), pins.end(), [&](uint32_t v) { return part(v) != part(pins[0]); });
+    };
+    auto identity = [](uint32_t v) { return v; };
+
+    std::vector<uint64_t> degree(H.n, 0);
+    for (size_t e = 0; e < H.numEdges(); ++e)
+        if (spans(H.edgePins(e), identity))
+            for (uint32_t v : H.edgePins(e))
+                degree[v] += H.weight(e);
+    std::vector<uint32_t> order(H.n);
+    std::iota(order.begin(), order.end(), 0u);
+    const uint32_t isolated = std::min(k - 1, H.n);
+    std::nth_element(order.begin(), order.begin() + isolated, order.end(), [&](uint32_t a, uint32_t b) { return degree[a] < degree[b]; });
+    std::vector<uint32_t> part(H.n, REST);
+    for (uint32_t i = 0; i < isolated; ++i)
+        part[order[i]] = order[i];
+
+    std::vector<uint32_t> cut;
+    for (size_t e = 0; e < H.numEdges(); ++e)
+        if (spans(H.edgePins(e), [&](uint32_t v) { return part[v]; }))
+            cut.push_back(static_cast<uint32_t>(e));
+    return cut;
+}
+
+template <class State>
+void getKSpanning(State &state, uint32_t k) {
+    HMC_PROBE(Probe::KSpanning);
+    state.refresh();
+    const uint32_t n = state.n();
+    uint32_t threshold = (n >= k - 1) ? (n - k + 2) : 1;
+    auto settle = [&](uint32_t e) {
+        const uint32_t size = state.edgeSize(e);
+        if (size >= threshold) {
+            state.cutEdge(e);
+        } else if (size <= 1) {
+            state.removeEdge(e);
         }
+    };
+    if constexpr (std::is_same_v<State, ContractionState>) {
+        state.forEachSpanCandidate(threshold, settle);
+    } else {
+        // Walk backwards so removals, which swap the last live edge into place, never skip an edge.
+        for (uint32_t i = state.numLiveEdges(); i-- > 0;)
+            settle(state.liveEdge(i));
     }
-    H.edges = std::move(kept);
 }
 
-size_t chooseRandomEdge(const Hypergraph &H, std::mt19937_64 &rng) {
-    if (H.edges.empty())
+// A live edge drawn by weight, or SIZE_MAX if no live edge has positive weight.
+template <class State>
+size_t chooseRandomEdge(const State &state, std::mt19937_64 &rng) {
+    HMC_PROBE(Probe::ChooseEdge);
+    if (state.numLiveEdges() == 0 || state.liveWeight() == 0)
         return SIZE_MAX;
 
-    std::vector<uint64_t> cumulative(H.edges.size());
-    cumulative[0] = H.edges[0].weight;
-    for (size_t i = 1; i < H.edges.size(); ++i) {
-        cumulative[i] = cumulative[i - 1] + H.edges[i].weight;
-    }
+    return state.edgeSampler().sample(rng);
+}
 
-    std::uniform_int_distribution<uint64_t> dist(0, cumulative.back() - 1);
-    uint64_t target = dist(rng);
+// Seed of one iteration, independent of which worker runs it or when.
+inline uint64_t iterationSeed(uint64_t baseSeed, uint64_t batch, uint64_t iter) noexcept {
+    return splitmix64(splitmix64(splitmix64(baseSeed) + batch) + iter);
+}
 
-    return static_cast<size_t>(std::lower_bound(cumulative.begin(), cumulative.end(), target + 1) - cumulative.begin());
+inline void atomicMin(std::atomic<uint64_t> &target, uint64_t value) noexcept {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
 }
 
-std::vector<Hyperedge> branchingContract(Hypergraph H, uint32_t k, std::vector<Hyperedge> S, std::mt19937_64 &rng, uint64_t &contractions, uint64_t &runtime, uint64_t cutoff) {
-    getKSpanning(H, k, S);
+// Shared by every node of every branching tree in a batch. contractions/runtime
+// are the batch-wide counters and bestCut is the lightest complete cut found so far.
+// stop ends the batch; it is raised by the runtime cutoff or by control expiring.
+struct BranchContext {
+    uint32_t k;
+    uint64_t cutoff;
+    std::atomic<uint64_t> &contractions;
+    std::atomic<uint64_t> &runtime;
+    std::atomic<uint64_t> &bestCut;
+    ThreadPool *pool = nullptr;
+    uint32_t parallelDepth = 0;
+    uint32_t parallelMinEdges = 0;
+    RandomizedMode mode = RandomizedMode::Branching;
+    std::atomic<bool> *stop = nullptr;
+    const SolveControl *control = nullptr;
+    // Let subtrees whose committed cut equals bestCut reach their leaves, so that
+    // iterations finding the best cut again can be counted.
+    bool keepTies = false;
+
+    bool pruned(uint64_t committed) const noexcept {
+        const uint64_t best = bestCut.load(std::memory_order_relaxed);
+        return keepTies ? committed > best : committed >= best;
+    }
 
-    if (runtime >= cutoff) {
-        throw BatchTimeout();
+    // Polled at every node instead of throwing: the atomics are read each time,
+    // the clock only every 64th call on a thread.
+    bool interrupted() const noexcept {
+        if (stop && stop->load(std::memory_order_relaxed))
+            return true;
+        thread_local uint32_t countdown = 64;
+        bool over = runtime.load(std::memory_order_relaxed) >= cutoff;
+        if (!over && control && --countdown == 0) {
+            countdown = 64;
+            over = control->expired();
+        }
+        if (over && stop)
+            stop->store(true, std::memory_order_relaxed);
+        return over;
     }
+};
 
-    runtime += static_cast<uint64_t>(H.edges.size()) * H.n;
-    ++contractions;
+// Lightest complete cut of a subtree, as original edge ids.
+struct BranchCut {
+    uint64_t weight;
+    std::pmr::vector<uint32_t> edges;
+};
 
-    if (H.edges.empty()) {
-        return S;
+// Subtree handed to another worker. It allocates from its own arena, so the
+// parent's arena is only ever touched by the parent's thread, and the parent
+// copies the result back before the task is released.
+template <class State>
+struct BranchTask {
+    Arena arena;
+    State state;
+    std::optional<BranchCut> cut;
+
+    explicit BranchTask(const State &parent) : state(parent, &arena) {}
+    ~BranchTask() { HMC_ADD_BYTES(arena.bytesAllocated()); }
+};
+
+// Returns the lightest cut found below this node, allocated from scratch, or
+// nullopt if nothing below it can beat bestCut. The cut committed so far lives in
+// state, so only leaves that improve on bestCut copy it out.
+template <class State>
+std::optional<BranchCut> branchingContract(State &state, const BranchContext &ctx, std::pmr::memory_resource *scratch, std::mt19937_64 &rng,
+                                           uint32_t depth = 0) {
+    // Small contracted graphs continue on a bitset state. It lives on the heap
+    // rather than in scratch, since many subtrees of one iteration may switch.
+    if constexpr (std::is_same_v<State, ContractionState>) {
+        if (state.n() <= SMALL_GRAPH_MAX_N) {
+            return dispatchSmall(state.n(), [&](auto words) {
+                SmallContractionState<words()> small(state);
+                return branchingContract(small, ctx, scratch, rng, depth);
+            });
+        }
+    }
+
+    HMC_DEPTH(depth);
+    getKSpanning(state, ctx.k);
+
+    // Sibling subtrees that already finished keep their cuts.
+    if (ctx.interrupted()) {
+        return std::nullopt;
     }
 
-    size_t edgeIndex = chooseRandomEdge(H, rng);
-    const Hyperedge &chosen = H.edges[edgeIndex];
+    ctx.runtime.fetch_add(static_cast<uint64_t>(state.numLiveEdges()) * state.n(), std::memory_order_relaxed);
+    ctx.contractions.fetch_add(1, std::memory_order_relaxed);
+
+    // Every cut below this node contains the committed edges, so none of them can beat bestCut.
+    if (ctx.pruned(state.cutWeight())) {
+        return std::nullopt;
+    }
+
+    // Weightless live edges cannot add to the cut, so the committed edges are one.
+    const size_t chosen = chooseRandomEdge(state, rng);
+    if (chosen == SIZE_MAX) {
+        atomicMin(ctx.bestCut, state.cutWeight());
+        auto edges = state.cutEdges();
+        return BranchCut{state.cutWeight(), std::pmr::vector<uint32_t>(edges.begin(), edges.end(), scratch)};
+    }
+    const uint32_t edgeIndex = static_cast<uint32_t>(chosen);
 
-    double z = redoProbability(H.n, static_cast<uint32_t>(chosen.vertices.size()), k);
+    double z = redoProbability(state.n(), state.edgeSize(edgeIndex), ctx.k);
 
     std::uniform_real_distribution<double> dist(0.0, 1.0);
     double r = dist(rng);
 
-    Hypergraph contracted = contractEdge(H, edgeIndex);
-    auto contractedCut = branchingContract(std::move(contracted), k, S, rng, contractions, runtime, cutoff);
+    auto lighter = [](std::optional<BranchCut> a, std::optional<BranchCut> b) {
+        if (!a || (b && b->weight < a->weight))
+            return b;
+        return a;
+    };
+
+    const auto checkpoint = state.checkpoint();
+    if (r > z) {
+        state.contract(edgeIndex);
+        auto contractedCut = branchingContract(state, ctx, scratch, rng, depth + 1);
+        state.rollback(checkpoint);
+        return contractedCut;
+    }
+
+    // The uncontracted branch is seeded before the contracted one runs, so how many
+    // draws pruning spares in one subtree never shifts the other's. rng is not
+    // drawn from again once a subtree has used it.
+    if (depth >= ctx.parallelDepth) {
+        std::mt19937_64 uncontractedRng(rng());
+        state.contract(edgeIndex);
+        auto contractedCut = branchingContract(state, ctx, scratch, rng, depth + 1);
+        state.rollback(checkpoint);
+        auto uncontractedCut = branchingContract(state, ctx, scratch, uncontractedRng, depth + 1);
+        state.rollback(checkpoint);
+        return lighter(std::move(contractedCut), std::move(uncontractedCut));
+    }
+
+    // Near the root each branch gets its own generator, so the result is the same
+    // whether or not the uncontracted branch is handed to another worker.
+    std::mt19937_64 contractedRng(rng());
+    std::mt19937_64 uncontractedRng(rng());
+    std::optional<BranchCut> uncontractedCut;
+    std::shared_ptr<BranchTask<State>> task;
+    std::optional<TaskGroup> group;
+    if (ctx.pool && ctx.pool->size() > 1 && state.numLiveEdges() >= ctx.parallelMinEdges) {
+        task = std::make_shared<BranchTask<State>>(state);
+        group.emplace(*ctx.pool);
+        group->run([&ctx, &uncontractedRng, depth, task] { task->cut = branchingContract(task->state, ctx, &task->arena, uncontractedRng, depth + 1); });
+    }
+    state.contract(edgeIndex);
+    auto contractedCut = branchingContract(state, ctx, scratch, contractedRng, depth + 1);
+    state.rollback(checkpoint);
+    if (group) {
+        group->wait();
+        if (task->cut)
+            uncontractedCut = BranchCut{task->cut->weight, std::pmr::vector<uint32_t>(task->cut->edges, scratch)};
+    } else {
+        uncontractedCut = branchingContract(state, ctx, scratch, uncontractedRng, depth + 1);
+        state.rollback(checkpoint);
+    }
+    return lighter(std::move(contractedCut), std::move(uncontractedCut));
+}
+
+// Minimum 2-cut of a state with at most 6 vertices, found by trying every
+// bipartition of them. Returns as branchingContract.
+template <class State>
+std::optional<BranchCut> exactSmallCut(State &state, const BranchContext &ctx, std::pmr::memory_resource *scratch) {
+    getKSpanning(state, 2);
+    const uint32_t n = state.n();
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> edges(scratch);
+    const uint32_t seen = state.forEachLiveEdgeDense([&](uint32_t e, std::span<const uint32_t> ids) {
+        uint32_t mask = 0;
+        for (uint32_t v : ids)
+            mask |= 1u << v;
+        edges.emplace_back(e, mask);
+    });
+    ctx.runtime.fetch_add(static_cast<uint64_t>(edges.size()) << (n > 1 ? n - 1 : 0), std::memory_order_relaxed);
+
+    // A vertex outside every live edge can be cut off without crossing one, which
+    // the empty side stands for. Otherwise vertex n - 1 stays out of every side.
+    auto crosses = [](uint32_t mask, uint32_t side) { return (mask & side) && (mask & ~side); };
+    uint32_t bestSide = 0;
+    if (seen == n && n >= 2) {
+        uint64_t best = std::numeric_limits<uint64_t>::max();
+        for (uint32_t side = 1; side < (1u << (n - 1)); ++side) {
+            uint64_t weight = 0;
+            for (auto [e, mask] : edges)
+                if (crosses(mask, side))
+                    weight += state.weight(e);
+            if (weight < best) {
+                best = weight;
+                bestSide = side;
+            }
+        }
+    }
+    for (auto [e, mask] : edges)
+        if (crosses(mask, bestSide))
+            state.cutEdge(e);
+
+    if (ctx.pruned(state.cutWeight()))
+        return std::nullopt;
+    atomicMin(ctx.bestCut, state.cutWeight());
+    auto cut = state.cutEdges();
+    return BranchCut{state.cutWeight(), std::pmr::vector<uint32_t>(cut.begin(), cut.end(), scratch)};
+}
+
+// Karger-Stein recursive contraction for k = 2. Each level contracts to about
+// n/sqrt(2) vertices and then recurses twice from the same contracted state, so
+// the early contractions are shared by both subtrees. An edge is drawn by weight
+// and accepted with probability 1 - |e|/n (the redo rule with k = 2), which favours
+// small edges the way hypergraph contraction needs to. Returns as branchingContract.
+template <class State>
+std::optional<BranchCut> recursiveContract(State &state, const BranchContext &ctx, std::pmr::memory_resource *scratch, std::mt19937_64 &rng,
+                                           uint32_t depth = 0) {
+    if constexpr (std::is_same_v<State, ContractionState>) {
+        if (state.n() <= SMALL_GRAPH_MAX_N) {
+            return dispatchSmall(state.n(), [&](auto words) {
+                SmallContractionState<words()> small(state);
+                return recursiveContract(small, ctx, scratch, rng, depth);
+            });
+        }
+    }
+    HMC_DEPTH(depth);
 
-    if (r <= z) {
-        auto uncontractedCut = branchingContract(std::move(H), k, S, rng, contractions, runtime, cutoff);
+    const uint32_t start = state.n();
+    if (start <= 6)
+        return exactSmallCut(state, ctx, scratch);
 
-        if (computeCutWeight(contractedCut) < computeCutWeight(contractedCut)) {
-            return contractedCut;
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    const uint32_t target = static_cast<uint32_t>(std::ceil(1.0 + start / std::numbers::sqrt2));
+    const auto checkpoint = state.checkpoint();
+
+    // Within a level only drawn edges are resized, and the full refresh runs once at
+    // the end. A drawn edge that has collapsed is dropped and one that spans every
+    // vertex is committed to the cut.
+    auto contractTo = [&](uint32_t target, std::mt19937_64 &gen) {
+        while (state.liveWeight() > 0 && state.n() > target && !ctx.pruned(state.cutWeight())) {
+            if (ctx.interrupted())
+                return false;
+            const uint32_t e = static_cast<uint32_t>(chooseRandomEdge(state, gen));
+            const uint32_t size = state.currentSize(e);
+            ctx.runtime.fetch_add(state.edgeSize(e), std::memory_order_relaxed);
+            if (size <= 1) {
+                state.removeEdge(e);
+            } else if (size >= state.n()) {
+                state.cutEdge(e);
+            } else if (dist(gen) > redoProbability(state.n(), size, 2)) {
+                state.contract(e);
+                ctx.contractions.fetch_add(1, std::memory_order_relaxed);
+            }
         }
+        ctx.runtime.fetch_add(static_cast<uint64_t>(state.numLiveEdges()) * state.n(), std::memory_order_relaxed);
+        getKSpanning(state, 2);
+        return true;
+    };
+    auto finish = [&](std::mt19937_64 &gen) -> std::optional<BranchCut> {
+        if (ctx.pruned(state.cutWeight()))
+            return std::nullopt;
+        if (state.liveWeight() > 0)
+            return recursiveContract(state, ctx, scratch, gen, depth + 1);
+        atomicMin(ctx.bestCut, state.cutWeight());
+        auto edges = state.cutEdges();
+        return BranchCut{state.cutWeight(), std::pmr::vector<uint32_t>(edges.begin(), edges.end(), scratch)};
+    };
+
+    // The second trial is seeded upfront, so pruning in the first never shifts it.
+    std::mt19937_64 secondRng(rng());
+    std::optional<BranchCut> best;
+    for (int trial = 0; trial < 2; ++trial) {
+        std::mt19937_64 &gen = trial == 0 ? rng : secondRng;
+        auto cut = contractTo(target, gen) ? finish(gen) : std::nullopt;
+        state.rollback(checkpoint);
+        if (cut && (!best || cut->weight < best->weight))
+            best = std::move(cut);
     }
+    return best;
+}
 
-    return contractedCut;
+// Contracts every edge heavier than bound, since no cut crossing one can beat it.
+inline void contractHeavier(ContractionState &state, uint64_t bound) {
+    const Hypergraph &H = state.graph();
+    for (uint32_t e = 0; e < H.numEdges(); ++e)
+        if (H.weight(e) > bound && state.currentSize(e) >= 2)
+            state.contract(e);
+    state.refresh();
 }
 
 uint64_t expectedRuntime(uint64_t n, uint64_t m, uint64_t k) {
@@ -197,30 +564,89 @@ uint64_t expectedRuntime(uint64_t n, uint64_t m, uint64_t k) {
     return static_cast<uint64_t>(m * std::pow(n, 2 * k - 2));
 }
 
-ContractionResult runOnce(const Hypergraph &H, uint32_t k, uint64_t cutoff, uint64_t &contractions, uint64_t &runtime, uint64_t seed) {
+// Branch results of the iteration are allocated from arena, which is reset on the
+// way out so the next iteration reuses the same memory.
+ContractionResult runOnce(ContractionState &state, Arena &arena, const BranchContext &ctx, uint64_t seed) {
     std::mt19937_64 rng(seed);
 
-    auto edges = branchingContract(H, k, {}, rng, contractions, runtime, cutoff);
+    const auto root = state.checkpoint();
+    std::optional<BranchCut> cut = ctx.mode == RandomizedMode::KargerStein ? recursiveContract(state, ctx, &arena, rng) : branchingContract(state, ctx, &arena, rng);
+    state.rollback(root);
 
     ContractionResult result;
-    result.numCut = edges.size();
-    result.cutWeight = computeCutWeight(edges);
-    result.totalContractions = contractions;
-    result.totalRuntime = runtime;
-    result.success = true;
+    result.numCut = cut ? cut->edges.size() : 0;
+    result.cutWeight = cut ? cut->weight : std::numeric_limits<uint64_t>::max();
+    result.totalContractions = ctx.contractions.load(std::memory_order_relaxed);
+    result.totalRuntime = ctx.runtime.load(std::memory_order_relaxed);
+    result.success = cut.has_value();
+    result.interrupted = ctx.stop ? ctx.stop->load(std::memory_order_relaxed) : ctx.runtime.load(std::memory_order_relaxed) >= ctx.cutoff;
+    if (cut)
+        result.cutEdges.assign(cut->edges.begin(), cut->edges.end());
+
+    cut.reset();
+    arena.reset();
+    return result;
+}
 
+ContractionResult runOnce(const Hypergraph &H, uint32_t k, uint64_t cutoff, uint64_t &contractions, uint64_t &runtime, uint64_t seed) {
+    ContractionState state(H);
+    Arena arena;
+    std::atomic<uint64_t> sharedContractions{contractions}, sharedRuntime{runtime};
+    std::atomic<uint64_t> bestCut{std::numeric_limits<uint64_t>::max()};
+    BranchContext ctx{k, cutoff, sharedContractions, sharedRuntime, bestCut};
+    auto result = runOnce(state, arena, ctx, seed);
+    contractions = sharedContractions.load();
+    runtime = sharedRuntime.load();
     return result;
 }
 
-ContractionResult randomizedMinKCut(const Hypergraph &H, uint32_t k, uint64_t batchScale, uint64_t numBatchesFactor, uint64_t baseSeed, bool verbose = false) {
+// Per-iteration outcomes across batches. An iteration is a trial that either
+// finds the current best cut again (a hit) or misses it. The first hit only
+// defines the best, so p = (hits - 1) / (trials + 1) estimates how often one
+// iteration finds the best cut, and 1 - (1 - p)^trials is used as the chance that
+// a lighter cut would have turned up by now. This is a heuristic: a lighter cut
+// may be found at a lower rate than p, so the estimate can be optimistic when
+// the best cut is not the minimum.
+struct TrialStats {
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    uint64_t hits = 0;
+    uint64_t trials = 0;
+
+    // Returns whether the batch improved the best cut.
+    bool record(std::span<const uint64_t> weights, uint64_t completed) {
+        const uint64_t batchBest = weights.empty() ? best : *std::min_element(weights.begin(), weights.end());
+        const bool improved = batchBest < best;
+        if (improved) {
+            best = batchBest;
+            hits = 0;
+        }
+        hits += std::count(weights.begin(), weights.end(), best);
+        trials += completed;
+        return improved;
+    }
+
+    double successEstimate() const {
+        if (hits < 2 || trials == 0)
+            return 0.0;
+        const double p = static_cast<double>(hits - 1) / static_cast<double>(trials + 1);
+        return 1.0 - std::pow(1.0 - p, static_cast<double>(trials));
+    }
+};
+
+ContractionResult randomizedMinKCut(const Hypergraph &H, uint32_t k, const RandomizedOptions &options) {
+    if (options.mode == RandomizedMode::KargerStein && k != 2)
+        throw std::runtime_error("Karger-Stein mode only supports k = 2");
+    const uint64_t batchScale = options.batchScale;
+    const bool verbose = options.verbose;
     uint64_t logN = static_cast<uint64_t>(std::max(1.0, std::log(static_cast<double>(H.n))));
-    uint64_t T = expectedRuntime(H.n, H.edges.size(), k);
-    uint64_t cutoff = 4 * batchScale * T * logN;
-    uint64_t numBatches = numBatchesFactor * logN;
+    uint64_t T = expectedRuntime(H.n, H.numEdges(), k);
+    // A Karger-Stein run finds a given minimum cut with probability Omega(1/log n),
+    // so c log n runs miss it with probability about e^-c. Each run costs several
+    // branching iterations, and it gets numBatchesFactor batches, not log n times
+    // as many.
+    uint64_t numBatches = options.numBatchesFactor * (options.mode == RandomizedMode::KargerStein ? 1 : logN);
     uint64_t iterationsPerBatch = batchScale * logN;
-
-    std::cout << "batches: " << numBatches << std::endl;
-    std::cout << "iterations: " << iterationsPerBatch << std::endl;
+    uint64_t cutoff = 4 * T * iterationsPerBatch;
 
     if (verbose)
         std::cout << "Expected runtime: " << T << "\n"
@@ -234,32 +660,101 @@ ContractionResult randomizedMinKCut(const Hypergraph &H, uint32_t k, uint64_t ba
     std::vector<ContractionResult> batchBests;
     batchBests.reserve(numBatches);
 
-    std::mt19937_64 seedGen(baseSeed ? baseSeed : std::random_device{}());
-    std::vector<uint64_t> results;
-
-    for (uint64_t batch = 0; batch < numBatches; batch++) {
-        uint64_t batchContractions = 0;
-        uint64_t batchRuntime = 0;
-
-        ContractionResult batchBest;
+    // The cut given by the bounds, returned when no iteration matches it.
+    const CutBounds *bounds = k == 2 && options.bounds && options.bounds->side.size() == H.n ? options.bounds : nullptr;
+    auto boundCut = [&](StopReason reason) {
+        ContractionResult result{};
+        for (uint32_t e = 0; e < H.numEdges(); ++e) {
+            auto pins = H.edgePins(e);
+            if (std::any_of(pins.begin(), pins.end(), [&](uint32_t v) { return bounds->side[v] != bounds->side[pins[0]]; })) {
+                result.cutEdges.push_back(e);
+                result.cutWeight += H.weight(e);
+            }
+        }
+        result.numCut = result.cutEdges.size();
+        result.cut = materializeCut(H, result.cutEdges);
+        result.success = true;
+        result.stopReason = reason;
+        options.control.improved(result.cutWeight);
+        return result;
+    };
+
+    const uint64_t baseSeed = options.baseSeed ? options.baseSeed : std::random_device{}();
+    ThreadPool pool(ThreadPool::resolveThreads(options.threads));
+    std::vector<std::unique_ptr<ContractionState>> states(pool.size());
+    std::vector<Arena> arenas(pool.size());
+    std::atomic<uint64_t> bestCut{bounds ? bounds->upper : std::numeric_limits<uint64_t>::max()};
+    if (bounds) {
+        if (bounds->exact())
+            return boundCut(StopReason::LowerBound);
+        // Every cut lighter than the bound survives; if fewer than k vertices
+        // remain there is none.
+        states[0] = std::make_unique<ContractionState>(H);
+        contractHeavier(*states[0], bounds->upper);
+        if (states[0]->n() < k)
+            return boundCut(StopReason::LowerBound);
+    }
+    uint64_t reported = std::numeric_limits<uint64_t>::max();
+    bool interrupted = false;
+    const bool adaptive = options.failureProbability > 0.0;
+    const uint64_t batchLimit = adaptive ? std::max(numBatches, options.maxBatches ? options.maxBatches : 2 * numBatches) : numBatches;
+    TrialStats stats;
+    StopReason stopReason = adaptive ? StopReason::BatchLimit : StopReason::Schedule;
+    uint64_t batchesRun = 0;
+
+    for (uint64_t batch = 0; batch < batchLimit; batch++) {
+        if (options.control.expired()) {
+            interrupted = true;
+            break;
+        }
+        ++batchesRun;
+        std::atomic<uint64_t> batchContractions{0};
+        std::atomic<uint64_t> batchRuntime{0};
+        std::atomic<bool> stopped{false};
+        BranchContext ctx{k, cutoff, batchContractions, batchRuntime, bestCut, &pool, options.parallelBranchDepth, options.parallelBranchMinEdges,
+                          options.mode, &stopped, &options.control, adaptive};
+
+        std::mutex batchMutex;
+        ContractionResult batchBest{};
         batchBest.cutWeight = std::numeric_limits<uint64_t>::max();
         bool anySuccess = false;
-        for (uint64_t iter = 0; iter < iterationsPerBatch; ++iter) {
-            try {
-                uint64_t seed = seedGen();
-                auto result = runOnce(H, k, cutoff, batchContractions, batchRuntime, seed);
-                if (result.cutWeight < batchBest.cutWeight) {
-                    batchBest = result;
-                }
-                anySuccess = true;
-            } catch (const BatchTimeout &) {
+        bool reportedStop = false;
+        std::vector<uint64_t> weights;
+        uint64_t completed = 0;
+        parallelFor(pool, iterationsPerBatch, [&](size_t iter, unsigned slot) {
+            if (stopped.load(std::memory_order_relaxed))
+                return;
+            if (!states[slot]) {
+                states[slot] = std::make_unique<ContractionState>(H);
+                if (bounds)
+                    contractHeavier(*states[slot], bounds->upper);
+            }
+            auto result = runOnce(*states[slot], arenas[slot], ctx, iterationSeed(baseSeed, batch, iter));
+            std::lock_guard lock(batchMutex);
+            if (result.success && result.cutWeight < reported) {
+                reported = result.cutWeight;
+                options.control.improved(reported);
+            }
+            if (result.interrupted && !reportedStop) {
+                reportedStop = true;
                 std::cout << "Batch #" << batch << " timed out at iteration " << iter << "/" << iterationsPerBatch << "\n";
-                break;
             }
-        }
+            anySuccess |= !result.interrupted;
+            if (!result.interrupted) {
+                ++completed;
+                if (result.success)
+                    weights.push_back(result.cutWeight);
+            }
+            // An interrupted iteration still counts if it completed a cut before stopping.
+            if (result.success && result.cutWeight < batchBest.cutWeight) {
+                batchBest = std::move(result);
+            }
+        });
 
+        if (batchBest.success)
+            batchBests.push_back(std::move(batchBest));
         if (anySuccess) {
-            batchBests.push_back(batchBest);
+            // Every iteration of a batch can be pruned by cuts that earlier batches found.
             if (verbose)
                 std::cout << "Batch #" << batch << " completed in " << batchRuntime << " units (" << (100.0 * batchRuntime / cutoff) << "% of cutoff)\n";
         } else {
@@ -268,18 +763,75 @@ ContractionResult randomizedMinKCut(const Hypergraph &H, uint32_t k, uint64_t ba
 
         totalContractions += batchContractions;
         totalRuntime += batchRuntime;
-    }
 
+        const bool improved = stats.record(weights, completed);
+        if (verbose)
+            std::cout << "Batch #" << batch << ": best " << stats.best << ", hits " << stats.hits << "/" << stats.trials << ", success estimate "
+                      << stats.successEstimate() << "\n";
+        if (bounds && stats.best <= bounds->lower) {
+            stopReason = StopReason::LowerBound;
+            break;
+        }
+        if (adaptive && stats.successEstimate() >= 1.0 - options.failureProbability) {
+            stopReason = StopReason::Confident;
+            break;
+        }
+        if (batch + 1 >= numBatches && !(adaptive && improved)) {
+            stopReason = StopReason::Schedule;
+            break;
+        }
+    }
+#ifdef HMC_INSTRUMENT
+    for (const Arena &arena : arenas)
+        HMC_ADD_BYTES(arena.bytesAllocated());
+#endif
+    interrupted |= options.control.expired();
+    if (interrupted)
+        stopReason = StopReason::Interrupted;
+
+    if (batchBests.empty() && bounds) {
+        ContractionResult result = boundCut(stopReason);
+        result.totalContractions = totalContractions;
+        result.totalRuntime = totalRuntime;
+        result.interrupted = interrupted;
+        result.batches = batchesRun;
+        return result;
+    }
     if (batchBests.empty()) {
-        throw std::runtime_error("All batches failed to find a cut");
+        if (!interrupted)
+            throw std::runtime_error("All batches failed to find a cut");
+        ContractionResult fallback{};
+        fallback.cutEdges = isolatingCut(H, k);
+        fallback.numCut = fallback.cutEdges.size();
+        fallback.cutWeight = 0;
+        for (uint32_t e : fallback.cutEdges)
+            fallback.cutWeight += H.weight(e);
+        fallback.cut = materializeCut(H, fallback.cutEdges);
+        fallback.totalContractions = totalContractions;
+        fallback.totalRuntime = totalRuntime;
+        fallback.success = true;
+        fallback.interrupted = true;
+        fallback.stopReason = stopReason;
+        fallback.batches = batchesRun;
+        options.control.improved(fallback.cutWeight);
+        return fallback;
     }
 
     auto best = std::min_element(batchBests.begin(), batchBests.end(), [](const auto &a, const auto &b) { return a.cutWeight < b.cutWeight; });
 
-    ContractionResult result = *best;
+    ContractionResult result = std::move(*best);
+    result.cut = materializeCut(H, result.cutEdges);
     result.totalContractions = totalContractions;
     result.totalRuntime = totalRuntime;
+    result.interrupted = interrupted;
+    result.stopReason = stopReason;
+    result.successEstimate = stats.successEstimate();
+    result.batches = batchesRun;
     return result;
 }
 
+ContractionResult randomizedMinKCut(const Hypergraph &H, uint32_t k, uint64_t batchScale, uint64_t numBatchesFactor, uint64_t baseSeed, bool verbose = false) {
+    return randomizedMinKCut(H, k, RandomizedOptions{.batchScale = batchScale, .numBatchesFactor = numBatchesFactor, .baseSeed = baseSeed, .verbose = verbose});
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "randomized.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Relabels every pin through vertexMap, drops duplicate pins, zero-weight edges and
+// edges left with fewer than two vertices. Surviving edges keep their order.
+inline Hypergraph quotient(const Hypergraph &H, std::span<const uint32_t> vertexMap, uint32_t newN) {
+    Hypergraph Q;
+    Q.n = newN;
+    Q.reserve(H.numEdges(), H.numPins());
+    PinDedup dedup(newN);
+    std::vector<uint32_t> edgeVertices;
+    for (size_t e = 0; e < H.numEdges(); ++e) {
+        if (H.weight(e) == 0)
+            continue;
+        edgeVertices.resize(H.edgeSize(e));
+        const size_t size = dedup.relabelUnique(H.edgePins(e), vertexMap.data(), edgeVertices.data());
+        if (size > 1)
+            Q.addEdge(std::span<const uint32_t>(edgeVertices.data(), size), H.weight(e));
+    }
+    return Q;
+}
+
+// Replaces every group of edges with identical (sorted) pin sets by its first edge
+// carrying the group's total weight, saturated at UINT32_MAX.
+inline Hypergraph mergeParallelEdges(const Hypergraph &H) {
+    const size_t m = H.numEdges();
+    std::vector<std::pair<uint64_t, uint32_t>> keys(m);
+    for (size_t e = 0; e < m; ++e) {
+        uint64_t h = 0xcbf29ce484222325ull ^ H.edgeSize(e);
+        for (uint32_t v : H.edgePins(e))
+            h = (h ^ v) * 0x100000001b3ull;
+        keys[e] = {h, static_cast<uint32_t>(e)};
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> target(m);
+    std::vector<uint64_t> merged(m, 0);
+    for (size_t i = 0; i < m;) {
+        size_t j = i;
+        while (j < m && keys[j].first == keys[i].first)
+            ++j;
+        // Hash collisions are rare, so equal-hash runs are compared pairwise.
+        for (size_t a = i; a < j; ++a) {
+            const uint32_t e = keys[a].second;
+            target[e] = e;
+            for (size_t b = i; b < a; ++b) {
+                const uint32_t f = keys[b].second;
+                auto x = H.edgePins(e), y = H.edgePins(f);
+                if (target[f] == f && std::equal(x.begin(), x.end(), y.begin(), y.end())) {
+                    target[e] = f;
+                    break;
+                }
+            }
+            merged[target[e]] += H.weight(e);
+        }
+        i = j;
+    }
+
+    Hypergraph R;
+    R.n = H.n;
+    R.reserve(m, H.numPins());
+    for (size_t e = 0; e < m; ++e) {
+        if (target[e] == e)
+            R.addEdge(H.edgePins(e), static_cast<uint32_t>(std::min<uint64_t>(merged[e], std::numeric_limits<uint32_t>::max())));
+    }
+    return R;
+}
+
+// Result of kernelize(). The min cut of the original hypergraph is
+// min(bound, min cut of graph); bound is the lightest cut discarded on the way
+// and boundSide lists the original vertices on one side of it.
+struct Reduction {
+    Hypergraph graph;
+    std::vector<uint32_t> vertexMap;
+    uint64_t bound = std::numeric_limits<uint64_t>::max();
+    std::vector<uint32_t> boundSide;
+
+    uint64_t lift(uint64_t reducedMinCut) const noexcept { return std::min(reducedMinCut, bound); }
+
+    // Maps a side assignment of the reduced vertices back to the original vertices.
+    std::vector<bool> liftPartition(const std::vector<bool> &reducedSide) const {
+        std::vector<bool> side(vertexMap.size());
+        for (size_t v = 0; v < vertexMap.size(); ++v)
+            side[v] = reducedSide[vertexMap[v]];
+        return side;
+    }
+};
+
+// Shrinks H while preserving its minimum (2-way) cut value. Repeated until nothing changes:
+//   - single-pin and zero-weight edges are dropped and parallel edges merged;
+//   - the minimum weighted degree U becomes an upper bound (its vertex is a cut);
+//   - every edge of weight >= U is contracted, since a cut crossing it is no lighter
+//     than the recorded one. This also folds every degree-one vertex into its
+//     neighbours, because its only edge weighs exactly its degree, which is >= U.
+// A known cut of H, given as its weight and the vertices on one side, seeds U.
+inline Reduction kernelize(const Hypergraph &H, uint64_t bound = std::numeric_limits<uint64_t>::max(), std::vector<uint32_t> boundSide = {}) {
+    Reduction r;
+    r.bound = bound;
+    r.boundSide = std::move(boundSide);
+    r.vertexMap.resize(H.n);
+    std::iota(r.vertexMap.begin(), r.vertexMap.end(), 0u);
+    r.graph = mergeParallelEdges(quotient(H, r.vertexMap, H.n));
+
+    std::vector<uint64_t> degree;
+    std::vector<uint32_t> newId;
+    while (r.graph.n > 1) {
+        const Hypergraph &G = r.graph;
+        degree.assign(G.n, 0);
+        for (size_t e = 0; e < G.numEdges(); ++e)
+            for (uint32_t v : G.edgePins(e))
+                degree[v] += G.weight(e);
+        const uint32_t lightest = static_cast<uint32_t>(std::min_element(degree.begin(), degree.end()) - degree.begin());
+        if (degree[lightest] < r.bound) {
+            r.bound = degree[lightest];
+            r.boundSide.clear();
+            for (uint32_t v = 0; v < H.n; ++v)
+                if (r.vertexMap[v] == lightest)
+                    r.boundSide.push_back(v);
+        }
+
+        DSU dsu(G.n);
+        for (size_t e = 0; e < G.numEdges(); ++e) {
+            if (G.weight(e) < r.bound)
+                continue;
+            auto pins = G.edgePins(e);
+            for (uint32_t v : pins.subspan(1))
+                dsu.unite(pins[0], v);
+        }
+        if (dsu.components() == G.n)
+            break;
+
+        newId.assign(G.n, std::numeric_limits<uint32_t>::max());
+        uint32_t next = 0;
+        for (uint32_t v = 0; v < G.n; ++v) {
+            const uint32_t root = dsu.find(v);
+            if (newId[root] == std::numeric_limits<uint32_t>::max())
+                newId[root] = next++;
+            newId[v] = newId[root];
+        }
+        for (auto &v : r.vertexMap)
+            v = newId[v];
+        r.graph = mergeParallelEdges(quotient(G, newId, next));
+    }
+    return r;
+}
+
+// Runs `solve` on the kernel of H and lifts its value back, e.g.
+//   reducedMinCut(H, [](const Hypergraph &G) { return deterministicMinCut(G); })
+template <class Solve>
+uint64_t reducedMinCut(const Hypergraph &H, Solve &&solve) {
+    if (H.n <= 1)
+        return 0;
+    Reduction r = kernelize(H);
+    if (r.graph.n <= 1)
+        return r.bound;
+    return r.lift(solve(r.graph));
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Weighted sampler over edge ids backed by a Fenwick tree: O(log m) draws and
+// weight updates. Updates are logged so the sampler can roll back to a checkpoint.
+class EdgeSampler {
+    std::pmr::vector<uint64_t> tree;
+    std::pmr::vector<uint32_t> weights;
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> log;
+    uint64_t sum = 0;
+    size_t topStep = 0;
+
+    void add(uint32_t e, int64_t delta) noexcept {
+        for (size_t i = e + 1; i < tree.size(); i += i & -i)
+            tree[i] += static_cast<uint64_t>(delta);
+        sum += static_cast<uint64_t>(delta);
+    }
+
+  public:
+    explicit EdgeSampler(std::span<const uint32_t> initial, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : tree(initial.size() + 1, 0, resource), weights(initial.begin(), initial.end(), resource), log(resource) {
+        for (size_t i = 1; i < tree.size(); ++i) {
+            tree[i] += weights[i - 1];
+            sum += weights[i - 1];
+            size_t parent = i + (i & -i);
+            if (parent < tree.size())
+                tree[parent] += tree[i];
+        }
+        topStep = weights.empty() ? 0 : std::bit_floor(weights.size());
+    }
+
+    EdgeSampler(const EdgeSampler &other, std::pmr::memory_resource *resource)
+        : tree(other.tree, resource), weights(other.weights, resource), log(other.log, resource), sum(other.sum), topStep(other.topStep) {}
+
+    uint64_t total() const noexcept { return sum; }
+    uint32_t weight(uint32_t e) const noexcept { return weights[e]; }
+
+    void set(uint32_t e, uint32_t w) {
+        if (weights[e] == w)
+            return;
+        log.emplace_back(e, weights[e]);
+        add(e, static_cast<int64_t>(w) - static_cast<int64_t>(weights[e]));
+        weights[e] = w;
+    }
+
+    // Edge whose cumulative weight range contains target, for target < total().
+    uint32_t find(uint64_t target) const noexcept {
+        size_t pos = 0;
+        for (size_t step = topStep; step; step >>= 1) {
+            if (pos + step < tree.size() && tree[pos + step] <= target) {
+                pos += step;
+                target -= tree[pos];
+            }
+        }
+        return static_cast<uint32_t>(pos);
+    }
+
+    // Draws need total() > 0.
+    uint32_t sample(std::mt19937_64 &rng) const {
+        std::uniform_int_distribution<uint64_t> dist(0, sum - 1);
+        return find(dist(rng));
+    }
+
+    // Independent draws with replacement. Targets are resolved in sorted order so
+    // consecutive descents share the cached upper levels of the tree.
+    void sampleMany(std::mt19937_64 &rng, size_t count, std::vector<uint32_t> &out) const {
+        std::uniform_int_distribution<uint64_t> dist(0, sum - 1);
+        std::vector<std::pair<uint64_t, size_t>> targets(count);
+        for (size_t i = 0; i < count; ++i)
+            targets[i] = {dist(rng), i};
+        std::sort(targets.begin(), targets.end());
+        out.resize(count);
+        for (const auto &[target, i] : targets)
+            out[i] = find(target);
+    }
+
+    size_t checkpoint() const noexcept { return log.size(); }
+
+    void rollback(size_t checkpoint) noexcept {
+        while (log.size() > checkpoint) {
+            auto [e, w] = log.back();
+            log.pop_back();
+            add(e, static_cast<int64_t>(w) - static_cast<int64_t>(weights[e]));
+            weights[e] = w;
+        }
+    }
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define HMC_X86 1
+#endif
+
+// Gather-sort-dedup kernels for pin lists: relabelling through a flat vertex map
+// and reducing an edge to its sorted distinct pins. Gathers use AVX-512 or AVX2
+// when the running CPU has them; everything else is branch-free scalar code.
+// Gather indices are signed 32-bit, so vertex ids must stay below 2^31.
+
+inline void relabelScalar(const uint32_t *in, size_t count, const uint32_t *map, uint32_t *out) noexcept {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = map[in[i]];
+}
+
+#ifdef HMC_X86
+__attribute__((target("avx2"))) inline void relabelAvx2(const uint32_t *in, size_t count, const uint32_t *map, uint32_t *out) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_i32gather_epi32(reinterpret_cast<const int *>(map), idx, 4));
+    }
+    relabelScalar(in + i, count - i, map, out + i);
+}
+
+__attribute__((target("avx512f"))) inline void relabelAvx512(const uint32_t *in, size_t count, const uint32_t *map, uint32_t *out) noexcept {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i idx = _mm512_loadu_si512(in + i);
+        _mm512_storeu_si512(out + i, _mm512_i32gather_epi32(idx, map, 4));
+    }
+    if (i < count) {
+        const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+        const __m512i idx = _mm512_maskz_loadu_epi32(tail, in + i);
+        _mm512_mask_storeu_epi32(out + i, tail, _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), tail, idx, map, 4));
+    }
+}
+#endif
+
+using RelabelKernel = void (*)(const uint32_t *, size_t, const uint32_t *, uint32_t *) noexcept;
+
+inline RelabelKernel selectRelabelKernel() noexcept {
+#ifdef HMC_X86
+    if (__builtin_cpu_supports("avx512f"))
+        return relabelAvx512;
+    if (__builtin_cpu_supports("avx2"))
+        return relabelAvx2;
+#endif
+    return relabelScalar;
+}
+
+// out[i] = map[in[i]]; out may alias in.
+inline void relabel(std::span<const uint32_t> in, const uint32_t *map, uint32_t *out) noexcept {
+    static const RelabelKernel kernel = selectRelabelKernel();
+    kernel(in.data(), in.size(), map, out);
+}
+
+// Sorts up to 8 values with a 19-comparator network; slots past count are padded
+// with UINT32_MAX and discarded.
+inline void sortNetwork8(uint32_t *pins, size_t count) noexcept {
+    uint32_t v[8];
+    for (size_t i = 0; i < 8; ++i)
+        v[i] = i < count ? pins[i] : UINT32_MAX;
+    auto cmpSwap = [&](int a, int b) {
+        const uint32_t lo = std::min(v[a], v[b]), hi = std::max(v[a], v[b]);
+        v[a] = lo;
+        v[b] = hi;
+    };
+    cmpSwap(0, 2), cmpSwap(1, 3), cmpSwap(4, 6), cmpSwap(5, 7);
+    cmpSwap(0, 4), cmpSwap(1, 5), cmpSwap(2, 6), cmpSwap(3, 7);
+    cmpSwap(0, 1), cmpSwap(2, 3), cmpSwap(4, 5), cmpSwap(6, 7);
+    cmpSwap(2, 4), cmpSwap(3, 5);
+    cmpSwap(1, 4), cmpSwap(3, 6);
+    cmpSwap(1, 2), cmpSwap(3, 4), cmpSwap(5, 6);
+    std::copy_n(v, count, pins);
+}
+
+// Drops adjacent duplicates from a sorted range without branches; returns the new size.
+inline size_t uniqueSorted(uint32_t *pins, size_t count) noexcept {
+    if (count == 0)
+        return 0;
+    size_t k = 1;
+    for (size_t i = 1; i < count; ++i) {
+        pins[k] = pins[i];
+        k += pins[i] != pins[k - 1];
+    }
+    return k;
+}
+
+// Reduces pin lists over vertex ids [0, universe) to their sorted distinct pins.
+// Small edges go through the sorting network, wide ones through a bitmap that is
+// scanned between the lowest and highest pin, and the rest through std::sort.
+class PinDedup {
+    std::vector<uint64_t> bitmap;
+
+  public:
+    explicit PinDedup(uint32_t universe) : bitmap(universe / 64 + 1, 0) {}
+
+    size_t sortUnique(uint32_t *pins, size_t count) {
+        if (count <= 8) {
+            sortNetwork8(pins, count);
+            return uniqueSorted(pins, count);
+        }
+        if (count >= 64) {
+            uint32_t lo = UINT32_MAX, hi = 0;
+            for (size_t i = 0; i < count; ++i) {
+                bitmap[pins[i] >> 6] |= uint64_t{1} << (pins[i] & 63);
+                lo = std::min(lo, pins[i]);
+                hi = std::max(hi, pins[i]);
+            }
+            // Worth it when the scanned words are few compared to a sort of count pins.
+            if ((hi >> 6) - (lo >> 6) <= 4 * count) {
+                size_t k = 0;
+                for (uint32_t w = lo >> 6; w <= hi >> 6; ++w) {
+                    for (uint64_t bits = bitmap[w]; bits; bits &= bits - 1)
+                        pins[k++] = 64 * w + std::countr_zero(bits);
+                    bitmap[w] = 0;
+                }
+                return k;
+            }
+            for (size_t i = 0; i < count; ++i)
+                bitmap[pins[i] >> 6] = 0;
+        }
+        std::sort(pins, pins + count);
+        return uniqueSorted(pins, count);
+    }
+
+    // Writes the sorted distinct labels map[in[i]] to out and returns how many there are.
+    size_t relabelUnique(std::span<const uint32_t> in, const uint32_t *map, uint32_t *out) {
+        relabel(in, map, out);
+        return sortUnique(out, in.size());
+    }
+};
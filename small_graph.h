@@ -0,0 +1,386 @@
+#pragma once
+
+#include "contraction.h"
+#include "control.h"
+#include "hypergraph.h"
+#include "max_queue.h"
+#include "sampler.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Contracted graphs with at most this many vertices switch to SmallContractionState.
+inline constexpr uint32_t SMALL_GRAPH_MAX_N = 512;
+// smallMinCut scans W words per edge where the CSR version scans the edge's pins,
+// so on sparse inputs it only wins while masks are one or two words wide.
+inline constexpr uint32_t SMALL_MIN_CUT_MAX_N = 128;
+
+// Vertex set over [0, 64 * W).
+template <size_t W>
+struct SmallMask {
+    std::array<uint64_t, W> words{};
+
+    void set(uint32_t v) noexcept { words[v >> 6] |= uint64_t{1} << (v & 63); }
+    void reset(uint32_t v) noexcept { words[v >> 6] &= ~(uint64_t{1} << (v & 63)); }
+    bool test(uint32_t v) const noexcept { return words[v >> 6] >> (v & 63) & 1; }
+    void clear() noexcept { words.fill(0); }
+
+    uint32_t count() const noexcept {
+        uint32_t c = 0;
+        for (uint64_t w : words)
+            c += std::popcount(w);
+        return c;
+    }
+
+    bool intersects(const SmallMask &other) const noexcept {
+        uint64_t any = 0;
+        for (size_t i = 0; i < W; ++i)
+            any |= words[i] & other.words[i];
+        return any != 0;
+    }
+
+    uint32_t lowest() const noexcept {
+        for (size_t i = 0; i < W; ++i)
+            if (words[i])
+                return static_cast<uint32_t>(64 * i + std::countr_zero(words[i]));
+        return 64 * W;
+    }
+
+    // Calls f(v) for every v in this set but not in exclude.
+    template <class F>
+    void forEachNotIn(const SmallMask &exclude, F &&f) const {
+        for (size_t i = 0; i < W; ++i)
+            for (uint64_t w = words[i] & ~exclude.words[i]; w; w &= w - 1)
+                f(static_cast<uint32_t>(64 * i + std::countr_zero(w)));
+    }
+
+    bool operator==(const SmallMask &) const noexcept = default;
+};
+
+// Calls f(std::integral_constant<size_t, W>{}) for the narrowest W with n <= 64 * W.
+template <class F>
+decltype(auto) dispatchSmall(uint32_t n, F &&f) {
+    if (n <= 64)
+        return f(std::integral_constant<size_t, 1>{});
+    if (n <= 128)
+        return f(std::integral_constant<size_t, 2>{});
+    if (n <= 256)
+        return f(std::integral_constant<size_t, 4>{});
+    return f(std::integral_constant<size_t, 8>{});
+}
+
+// Side of the lightest phase cut of an MA-ordering solver: the vertices merged
+// into t before phase `phase`, where merges[i] is the pair merged after phase i.
+inline std::vector<bool> phaseCutSide(uint32_t n, const std::vector<std::pair<uint32_t, uint32_t>> &merges, size_t phase, uint32_t t) {
+    RollbackDSU dsu(n);
+    for (size_t i = 0; i < phase; ++i)
+        dsu.unite(merges[i].first, merges[i].second);
+    std::vector<bool> side(n);
+    for (uint32_t v = 0; v < n; ++v)
+        side[v] = dsu.find(v) == dsu.find(t);
+    return side;
+}
+
+// Lightest single-vertex cut from the incidence lists of an MA-ordering solver,
+// which only list edges spanning two or more vertices. Seeds the best cut, so a
+// solver stopped before its first phase ends still returns a valid one.
+inline std::pair<uint64_t, uint32_t> lightestVertexCut(const Hypergraph &H, const std::vector<std::vector<uint32_t>> &incident) {
+    std::pair<uint64_t, uint32_t> best{std::numeric_limits<uint64_t>::max(), 0};
+    for (uint32_t v = 0; v < H.n; ++v) {
+        uint64_t degree = 0;
+        for (uint32_t ei : incident[v])
+            degree += H.weight(ei);
+        best = std::min(best, {degree, v});
+    }
+    return best;
+}
+
+// Drop-in for ContractionState once at most 64 * W contracted vertices remain.
+// Every live edge is a mask of dense vertex ids, so sizes are always exact,
+// refresh() has nothing to do, and contracting an edge ORs its representative
+// into every overlapping edge. Edge ids are local; cutEdges() reports original ids.
+template <size_t W>
+class SmallContractionState {
+    using Mask = SmallMask<W>;
+
+    std::pmr::vector<Mask> masks;
+    std::pmr::vector<uint32_t> origin;
+    std::pmr::vector<uint32_t> weights;
+    std::pmr::vector<uint32_t> sizes;
+    std::pmr::vector<uint32_t> live;
+    std::pmr::vector<uint32_t> position;
+    std::pmr::vector<std::pair<uint32_t, Mask>> maskLog;
+    std::pmr::vector<uint32_t> cut;
+    EdgeSampler sampler;
+    uint64_t cutTotal;
+    uint32_t numLive;
+    uint32_t numVertices;
+
+    static EdgeSampler buildSampler(ContractionState &parent, std::pmr::memory_resource *resource) {
+        std::vector<uint32_t> w(parent.numLiveEdges());
+        for (uint32_t i = 0; i < parent.numLiveEdges(); ++i)
+            w[i] = parent.weight(parent.liveEdge(i));
+        return EdgeSampler(w, resource);
+    }
+
+  public:
+    struct Checkpoint {
+        size_t maskWrites;
+        size_t weightUpdates;
+        size_t cutSize;
+        uint64_t cutWeight;
+        uint32_t numLive;
+        uint32_t numVertices;
+    };
+
+    // Takes over the live edges and the cut of parent, which must have n() <= 64 * W.
+    SmallContractionState(ContractionState &parent, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : masks(resource), origin(resource), weights(resource), sizes(resource), live(resource), position(resource), maskLog(resource),
+          cut(parent.cutEdges().begin(), parent.cutEdges().end(), resource), sampler(buildSampler(parent, resource)), cutTotal(parent.cutWeight()),
+          numLive(parent.numLiveEdges()), numVertices(parent.n()) {
+        masks.reserve(numLive);
+        parent.forEachLiveEdgeDense([&](uint32_t e, std::span<const uint32_t> ids) {
+            Mask mask;
+            for (uint32_t v : ids)
+                mask.set(v);
+            masks.push_back(mask);
+            origin.push_back(e);
+            weights.push_back(parent.weight(e));
+            sizes.push_back(mask.count());
+        });
+        live.resize(numLive);
+        position.resize(numLive);
+        std::iota(live.begin(), live.end(), 0u);
+        std::iota(position.begin(), position.end(), 0u);
+    }
+
+    SmallContractionState(const SmallContractionState &other, std::pmr::memory_resource *resource)
+        : masks(other.masks, resource), origin(other.origin, resource), weights(other.weights, resource), sizes(other.sizes, resource),
+          live(other.live, resource), position(other.position, resource), maskLog(other.maskLog, resource), cut(other.cut, resource),
+          sampler(other.sampler, resource), cutTotal(other.cutTotal), numLive(other.numLive), numVertices(other.numVertices) {}
+
+    uint32_t n() const noexcept { return numVertices; }
+    uint32_t numLiveEdges() const noexcept { return numLive; }
+    uint32_t liveEdge(uint32_t i) const noexcept { return live[i]; }
+    uint64_t liveWeight() const noexcept { return sampler.total(); }
+    const EdgeSampler &edgeSampler() const noexcept { return sampler; }
+    uint32_t weight(uint32_t e) const noexcept { return weights[e]; }
+    std::span<const uint32_t> cutEdges() const noexcept { return cut; }
+    uint64_t cutWeight() const noexcept { return cutTotal; }
+    uint32_t edgeSize(uint32_t e) const noexcept { return sizes[e]; }
+    uint32_t currentSize(uint32_t e) const noexcept { return sizes[e]; }
+
+    void refresh() noexcept {}
+
+    // As ContractionState::forEachLiveEdgeDense.
+    template <class F>
+    uint32_t forEachLiveEdgeDense(F &&f) const {
+        std::array<uint32_t, 64 * W> dense;
+        std::array<uint32_t, 64 * W> ids;
+        Mask seen;
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < numLive; ++i) {
+            const uint32_t e = live[i];
+            uint32_t size = 0;
+            for (uint32_t word = 0; word < W; ++word) {
+                for (uint64_t bits = masks[e].words[word]; bits; bits &= bits - 1) {
+                    const uint32_t v = 64 * word + static_cast<uint32_t>(std::countr_zero(bits));
+                    if (!seen.test(v)) {
+                        seen.set(v);
+                        dense[v] = next++;
+                    }
+                    ids[size++] = dense[v];
+                }
+            }
+            f(e, std::span<const uint32_t>(ids.data(), size));
+        }
+        return next;
+    }
+
+    void removeEdge(uint32_t e) {
+        const uint32_t i = position[e];
+        const uint32_t last = live[--numLive];
+        live[i] = last;
+        position[last] = i;
+        live[numLive] = e;
+        position[e] = numLive;
+        sampler.set(e, 0);
+    }
+
+    void cutEdge(uint32_t e) {
+        removeEdge(e);
+        cut.push_back(origin[e]);
+        cutTotal += weights[e];
+    }
+
+    void contract(uint32_t e) {
+        HMC_PROBE(Probe::Contract);
+        const Mask merged = masks[e];
+        const uint32_t rep = merged.lowest();
+        removeEdge(e);
+        for (uint32_t i = 0; i < numLive; ++i) {
+            const uint32_t f = live[i];
+            if (!masks[f].intersects(merged))
+                continue;
+            Mask next = masks[f];
+            for (size_t w = 0; w < W; ++w)
+                next.words[w] &= ~merged.words[w];
+            next.set(rep);
+            if (next == masks[f])
+                continue;
+            maskLog.emplace_back(f, masks[f]);
+            masks[f] = next;
+            sizes[f] = next.count();
+        }
+        numVertices -= merged.count() - 1;
+    }
+
+    Checkpoint checkpoint() const noexcept { return {maskLog.size(), sampler.checkpoint(), cut.size(), cutTotal, numLive, numVertices}; }
+
+    void rollback(const Checkpoint &checkpoint) noexcept {
+        while (maskLog.size() > checkpoint.maskWrites) {
+            auto &[f, mask] = maskLog.back();
+            masks[f] = mask;
+            sizes[f] = mask.count();
+            maskLog.pop_back();
+        }
+        sampler.rollback(checkpoint.weightUpdates);
+        cut.resize(checkpoint.cutSize);
+        cutTotal = checkpoint.cutWeight;
+        numLive = checkpoint.numLive;
+        numVertices = checkpoint.numVertices;
+    }
+};
+
+// deterministicMinCut for H.n <= 64 * W: the same maximum adjacency phases, with
+// each edge's live vertices held as a mask. Merging needs no search through pin
+// slices, and an added edge raises the keys of its vertices outside the ordered
+// prefix in one pass over its words.
+template <size_t W, class Queue>
+uint64_t smallMinCut(const Hypergraph &H, std::vector<bool> *side = nullptr, const SolveControl *control = nullptr) {
+    using Mask = SmallMask<W>;
+    const uint32_t m = H.numEdges();
+
+    HMC_PROBE_AS(setup, Probe::Setup);
+    std::vector<Mask> masks(m);
+    std::vector<uint32_t> edgeSize(m);
+    std::vector<std::vector<uint32_t>> incident(H.n);
+    uint64_t totalWeight = 0;
+    for (uint32_t ei = 0; ei < m; ++ei) {
+        for (uint32_t v : H.edgePins(ei))
+            masks[ei].set(v);
+        edgeSize[ei] = masks[ei].count();
+        if (edgeSize[ei] >= 2)
+            masks[ei].forEachNotIn(Mask{}, [&](uint32_t v) { incident[v].push_back(ei); });
+        totalWeight += H.weight(ei);
+    }
+
+    std::vector<uint32_t> reps(H.n);
+    std::vector<uint32_t> repIndex(H.n);
+    std::iota(reps.begin(), reps.end(), 0u);
+    std::iota(repIndex.begin(), repIndex.end(), 0u);
+
+    std::vector<bool> edgeCrossed(m, false);
+    std::vector<uint32_t> crossed;
+    crossed.reserve(m);
+    Mask ordered;
+
+    Queue queue;
+    queue.reset(H.n, totalWeight);
+    HMC_ADD_BYTES(masks.size() * sizeof(Mask) + edgeSize.size() * 4 + H.numPins() * 4 + reps.size() * 8 + crossed.capacity() * 4);
+    HMC_PROBE_STOP(setup);
+
+    // Merges vertex a into vertex b.
+    auto merge = [&](uint32_t a, uint32_t b) {
+        HMC_PROBE(Probe::PhaseRebuild);
+        bool collapsed = false;
+        for (uint32_t ei : incident[a]) {
+            masks[ei].reset(a);
+            if (masks[ei].test(b)) {
+                collapsed |= --edgeSize[ei] < 2;
+            } else {
+                masks[ei].set(b);
+                incident[b].push_back(ei);
+            }
+        }
+        incident[a].clear();
+        incident[a].shrink_to_fit();
+        if (collapsed) {
+            std::erase_if(incident[b], [&](uint32_t ei) { return edgeSize[ei] < 2; });
+        }
+
+        const uint32_t last = reps.back();
+        reps[repIndex[a]] = last;
+        repIndex[last] = repIndex[a];
+        reps.pop_back();
+    };
+
+    auto [minCut, bestT] = lightestVertexCut(H, incident);
+    std::vector<std::pair<uint32_t, uint32_t>> merges;
+    size_t bestPhase = 0;
+    StopPoll expired(control);
+    if (control)
+        control->improved(minCut);
+    while (reps.size() > 1) {
+        HMC_PROBE_AS(rebuild, Probe::PhaseRebuild);
+        for (uint32_t v : reps)
+            queue.push(v, 0);
+        ordered.clear();
+        HMC_PROBE_STOP(rebuild);
+
+        uint32_t s = reps[0], t = reps[0];
+        uint64_t cutOfPhase = 0;
+
+        HMC_PROBE_AS(ordering, Probe::MaOrdering);
+        while (!queue.empty()) {
+            if (expired())
+                break;
+            auto [best, bestConn] = queue.popMax();
+            ordered.set(best);
+
+            s = t;
+            t = best;
+            cutOfPhase = bestConn;
+
+            for (uint32_t ei : incident[best]) {
+                if (!edgeCrossed[ei]) {
+                    edgeCrossed[ei] = true;
+                    crossed.push_back(ei);
+                    const uint64_t w = H.weight(ei);
+                    masks[ei].forEachNotIn(ordered, [&](uint32_t v) { queue.increase(v, w); });
+                }
+            }
+        }
+        HMC_PROBE_STOP(ordering);
+        if (expired())
+            break;
+        for (uint32_t ei : crossed)
+            edgeCrossed[ei] = false;
+        crossed.clear();
+
+        if (cutOfPhase < minCut) {
+            minCut = cutOfPhase;
+            bestPhase = merges.size();
+            bestT = t;
+            if (control)
+                control->improved(minCut);
+        }
+        merges.emplace_back(s, t);
+        if (incident[s].size() <= incident[t].size())
+            merge(s, t);
+        else
+            merge(t, s);
+    }
+
+    if (side)
+        *side = phaseCutSide(H.n, merges, bestPhase, bestT);
+    return minCut;
+}